@@ -1,5 +1,9 @@
 #include "button_handler.h"
 #include "config.h"
+#include "scheduler.h"
+#if KEYPAD_ADC_DMA
+#include <driver/adc.h>
+#endif
 
 // ===== LedFeedback (Non-blocking LED-Steuerung) =====
 
@@ -48,6 +52,19 @@ bool LedFeedback::isBusy() {
     return state != LED_IDLE;
 }
 
+uint32_t LedFeedback::msUntilNextUpdate() {
+    unsigned long elapsed = millis() - startTime;
+    
+    if (state == LED_OK) {
+        return elapsed >= LED_OK_DURATION_MS ? 0 : LED_OK_DURATION_MS - elapsed;
+    }
+    if (state == LED_ERROR_BLINK) {
+        // Nächste Blink-Flanke
+        return LED_ERROR_BLINK_MS - (elapsed % LED_ERROR_BLINK_MS);
+    }
+    return UINT32_MAX;
+}
+
 void LedFeedback::loop() {
     if (state == LED_IDLE) return;
     
@@ -85,10 +102,8 @@ AnalogKeypad::AnalogKeypad(uint8_t adcPin) {
     pin = adcPin;
     measuring = false;
     anzahlTasten = 0;
-    anzahlMessungen = 0;
     unterSchwellwert = 0;
-    summe = 0;
-    lastReadTime = 0;
+    messungZuruecksetzen();
     debugOutput = true;
     
     // Neue Member initialisieren
@@ -103,7 +118,10 @@ AnalogKeypad::AnalogKeypad(uint8_t adcPin) {
     
     for (int i = 0; i < NUM_KEYS; i++) {
         tastenWerte[i] = 0;
+        tastenStreuung[i] = KEYPAD_STREUUNG_START;
+        tabellenStreuung[i] = KEYPAD_STREUUNG_START;
     }
+    memset(tabelle, KEYPAD_LUT_MEHRDEUTIG, sizeof(tabelle));
 }
 
 void AnalogKeypad::begin() {
@@ -142,6 +160,11 @@ void AnalogKeypad::parseKalibrierung() {
         startIndex = kommaIndex + 1;
     }
     
+    for (int i = 0; i < NUM_KEYS; i++) {
+        tastenStreuung[i] = KEYPAD_STREUUNG_START;
+    }
+    tabelleAufbauen();
+    
     if (debugOutput) {
         Serial.print("Kalibrierwerte geladen: ");
         Serial.print(anzahlTasten);
@@ -154,6 +177,102 @@ void AnalogKeypad::setCalibration(const String& calibration) {
     parseKalibrierung();
 }
 
+// Entscheidungsgrenzen: Jeder Tabelleneintrag gehört der Taste mit dem kleinsten
+// Abstand in Einheiten ihrer Streuung (Grenze zwischen zwei Tasten = gleiche
+// Anzahl σ). Mehrdeutig sind Einträge im Schutzband um eine Grenze und Einträge
+// außerhalb der Reichweite jeder Taste.
+void AnalogKeypad::tabelleAufbauen() {
+    for (int t = 0; t < anzahlTasten; t++) {
+        tabellenStreuung[t] = tastenStreuung[t];
+    }
+    
+    for (int i = 0; i < KEYPAD_LUT_GROESSE; i++) {
+        float wert = (i << KEYPAD_LUT_SHIFT) + (1 << KEYPAD_LUT_SHIFT) / 2.0f;
+        float besteZ = 1e9f;
+        float zweiteZ = 1e9f;
+        int beste = -1;
+        
+        for (int t = 0; t < anzahlTasten; t++) {
+            float z = fabsf(wert - tastenWerte[t]) / tastenStreuung[t];
+            if (z < besteZ) {
+                zweiteZ = besteZ;
+                besteZ = z;
+                beste = t;
+            } else if (z < zweiteZ) {
+                zweiteZ = z;
+            }
+        }
+        
+        tabelle[i] = KEYPAD_LUT_MEHRDEUTIG;
+        if (beste < 0 || zweiteZ - besteZ < KEYPAD_LUT_Z_ABSTAND) continue;
+        
+        float reichweite = max((float)KEYPAD_TOLERANCE, (float)(KEYPAD_LUT_Z_MAX * tastenStreuung[beste]));
+        if (fabsf(wert - tastenWerte[beste]) <= reichweite) tabelle[i] = beste;
+    }
+}
+
+// Streuung der erkannten Taste nachführen (gleitend). Nur eindeutige Drücke
+// zählen: eine Fehlzuordnung würde sonst den Bereich der falschen Taste
+// verbreitern und die nächste wahrscheinlicher machen.
+void AnalogKeypad::streuungLernen(int taste) {
+    if (taste < 0 || taste >= anzahlTasten || anzahlGueltig < 2) return;
+    
+    float zTaste = fabsf(mittelwert - tastenWerte[taste]) / tastenStreuung[taste];
+    float zNachbar = 1e9f;
+    for (int t = 0; t < anzahlTasten; t++) {
+        if (t == taste) continue;
+        zNachbar = min(zNachbar, fabsf(mittelwert - tastenWerte[t]) / tastenStreuung[t]);
+    }
+    if (zTaste > KEYPAD_LERN_Z_MAX || zNachbar - zTaste < KEYPAD_LERN_Z_ABSTAND) return;
+    
+    float sigma = sqrtf(m2 / (anzahlGueltig - 1));
+    tastenStreuung[taste] = constrain(0.75f * tastenStreuung[taste] + 0.25f * sigma,
+                                      (float)KEYPAD_STREUUNG_MIN, (float)KEYPAD_STREUUNG_MAX);
+    
+    // Kleine Änderungen sammeln sich an, bis sie die Grenzen spürbar verschieben
+    if (fabsf(tastenStreuung[taste] - tabellenStreuung[taste]) > KEYPAD_STREUUNG_SCHWELLE * tabellenStreuung[taste]) {
+        tabelleAufbauen();
+    }
+}
+
+void AnalogKeypad::messungZuruecksetzen() {
+    anzahlMessungen = 0;
+    anzahlGueltig = 0;
+    mittelwert = 0;
+    m2 = 0;
+}
+
+// Median der letzten (höchstens KEYPAD_MEDIAN_FENSTER) Messwerte
+int AnalogKeypad::laufenderMedian() {
+    int n = min(anzahlMessungen, KEYPAD_MEDIAN_FENSTER);
+    int sortiert[KEYPAD_MEDIAN_FENSTER];
+    
+    for (int i = 0; i < n; i++) {
+        int wert = fenster[i];
+        int j = i;
+        while (j > 0 && sortiert[j - 1] > wert) {
+            sortiert[j] = sortiert[j - 1];
+            j--;
+        }
+        sortiert[j] = wert;
+    }
+    return sortiert[n / 2];
+}
+
+// Messwert aufnehmen: Ausreißer gegen den laufenden Median prüfen (statt gegen
+// den Mittelwert aller gespeicherten Werte), gültige Werte per Welford mitteln
+void AnalogKeypad::messwertAufnehmen(int wert) {
+    fenster[anzahlMessungen % KEYPAD_MEDIAN_FENSTER] = wert;
+    anzahlMessungen++;
+    
+    if (abs(wert - laufenderMedian()) > KEYPAD_TOLERANCE) return;
+    
+    anzahlGueltig++;
+    float delta = wert - mittelwert;
+    mittelwert += delta / anzahlGueltig;
+    m2 += delta * (wert - mittelwert);
+}
+
 int AnalogKeypad::berechneTaste() {
     float guete;
     return berechneTasteMitGuete(&guete);
@@ -168,43 +287,19 @@ int AnalogKeypad::berechneTasteMitGuete(float* gueteOut) {
         return -1;
     }
     
-    // Erster Mittelwert
-    float mittelwert1 = summe / (float)anzahlMessungen;
-    
-    // Bereinigter Mittelwert (ohne Ausreißer)
-    long summeBereinigt = 0;
-    int anzahlGueltig = 0;
-    
-    for (int i = 0; i < anzahlMessungen; i++) {
-        float abweichung = abs(messwerte[i] - mittelwert1);
-        
-        if (abweichung <= KEYPAD_TOLERANCE) {
-            summeBereinigt += messwerte[i];
-            anzahlGueltig++;
-        }
-    }
-    
+    // Bereinigter Mittelwert und Güte stehen nach jeder Messung schon fest
     if (anzahlGueltig == 0) {
         if (debugOutput) Serial.println("Keypad: Keine gültigen Werte!");
         return -1;
     }
     
-    int mittelwertBereinigt = summeBereinigt / anzahlGueltig;
+    int mittelwertBereinigt = (int)(mittelwert + 0.5f);
     float guete = (anzahlGueltig / (float)anzahlMessungen) * 100.0;
     *gueteOut = guete;
     
-    // Nächstgelegene Taste finden
-    int naechsteTaste = -1;
-    int kleinsterAbstand = 9999;
-    
-    for (int i = 0; i < anzahlTasten; i++) {
-        int abstand = abs(tastenWerte[i] - mittelwertBereinigt);
-        
-        if (abstand < kleinsterAbstand) {
-            kleinsterAbstand = abstand;
-            naechsteTaste = i;  // 0-basiert (Taste 0-15)
-        }
-    }
+    // Taste aus der Entscheidungstabelle (0-basiert, Taste 0-15)
+    uint8_t eintrag = tabelle[constrain(mittelwertBereinigt, 0, 4095) >> KEYPAD_LUT_SHIFT];
+    int naechsteTaste = (eintrag == KEYPAD_LUT_MEHRDEUTIG) ? -1 : eintrag;
     
     // Debug-Ausgabe
     if (debugOutput) {
@@ -212,6 +307,8 @@ int AnalogKeypad::berechneTasteMitGuete(float* gueteOut) {
         Serial.print(anzahlMessungen);
         Serial.print(" | Wert: ");
         Serial.print(mittelwertBereinigt);
+        Serial.print(" | σ: ");
+        Serial.print(anzahlGueltig > 1 ? sqrtf(m2 / (anzahlGueltig - 1)) : 0.0f, 1);
         Serial.print(" | Güte: ");
         Serial.print(guete, 1);
         Serial.print("% | Taste: ");
@@ -221,17 +318,12 @@ int AnalogKeypad::berechneTasteMitGuete(float* gueteOut) {
     return naechsteTaste;
 }
 
+// Eine Messung per analogRead - Aufruf im Takt KEYPAD_MESS_INTERVAL (Keypad-Task)
 int AnalogKeypad::loop() {
-    unsigned long now = millis();
-    
-    // Non-blocking: Nur alle KEYPAD_MESS_INTERVAL ms messen
-    if (now - lastReadTime < KEYPAD_MESS_INTERVAL) {
-        return KEYPAD_NO_KEY;
-    }
-    lastReadTime = now;
-    
-    int currentValue = analogRead(pin);
-    
+    return process(analogRead(pin));
+}
+
+int AnalogKeypad::process(int currentValue) {
     // === Sperr-Modus nach früher Erkennung ===
     if (locked) {
         if (currentValue > KEYPAD_THRESHOLD) {
@@ -262,19 +354,13 @@ int AnalogKeypad::loop() {
         if (!measuring) {
             // Neue Messung starten
             measuring = true;
-            anzahlMessungen = 0;
             unterSchwellwert = 0;
-            summe = 0;
+            messungZuruecksetzen();
             earlyDetected = false;
             erkanntesTaste = -1;
         }
         
-        // Messwert aufnehmen
-        if (anzahlMessungen < KEYPAD_MAX_MESSUNGEN) {
-            messwerte[anzahlMessungen] = currentValue;
-            summe += currentValue;
-            anzahlMessungen++;
-        }
+        messwertAufnehmen(currentValue);
         unterSchwellwert = 0;  // Reset Counter
         
         // === Frühe Prüfung nach KEYPAD_EARLY_CHECK_COUNT Messungen ===
@@ -298,9 +384,9 @@ int AnalogKeypad::loop() {
                 }
                 
                 // Reset für nächste Messung
+                streuungLernen(taste);
                 measuring = false;
-                anzahlMessungen = 0;
-                summe = 0;
+                messungZuruecksetzen();
                 lastResult = KEYPAD_NO_KEY;  // OK-Ergebnis
                 
                 return taste;  // Taste zurückgeben
@@ -322,11 +408,11 @@ int AnalogKeypad::loop() {
                     Serial.println("%");
                 }
                 
+                streuungLernen(taste);
                 locked = true;
                 lockCounter = 0;
                 measuring = false;
-                anzahlMessungen = 0;
-                summe = 0;
+                messungZuruecksetzen();
                 lastResult = KEYPAD_NO_KEY;
                 
                 return taste;
@@ -341,8 +427,7 @@ int AnalogKeypad::loop() {
                 }
                 
                 measuring = false;
-                anzahlMessungen = 0;
-                summe = 0;
+                messungZuruecksetzen();
                 lastResult = KEYPAD_ERROR;
                 
                 return KEYPAD_ERROR;  // Fehler-Signal
@@ -364,13 +449,14 @@ int AnalogKeypad::loop() {
                 if (!earlyDetected && anzahlMessungen >= KEYPAD_MIN_MESSUNGEN) {
                     float guete = 0;
                     int taste = berechneTasteMitGuete(&guete);
+                    bool erkannt = taste >= 0 && guete >= KEYPAD_MIN_GUETE;
+                    if (erkannt) streuungLernen(taste);
                     
                     // Reset für nächste Messung
-                    anzahlMessungen = 0;
                     unterSchwellwert = 0;
-                    summe = 0;
+                    messungZuruecksetzen();
                     
-                    if (taste >= 0 && guete >= KEYPAD_MIN_GUETE) {
+                    if (erkannt) {
                         lastResult = KEYPAD_NO_KEY;
                         return taste;
                     } else {
@@ -380,9 +466,8 @@ int AnalogKeypad::loop() {
                 }
                 
                 // Reset für nächste Messung
-                anzahlMessungen = 0;
                 unterSchwellwert = 0;
-                summe = 0;
+                messungZuruecksetzen();
             }
         }
     }
@@ -540,36 +625,137 @@ ButtonHandler::ButtonHandler() {
     rfReceiver = new RFReceiver();
     ledFeedback = new LedFeedback(LED_FEEDBACK_PIN, LED_ACTIVE_HIGH);
     instance = this;
+    adcDma = false;
+    dmaSum = 0;
+    dmaCount = 0;
 }
 
 // Keypad-Task läuft auf Core 0 (unabhängig vom Hauptloop)
 void ButtonHandler::keypadTask(void* parameter) {
-    AnalogKeypad* kp = (AnalogKeypad*)parameter;
+    ButtonHandler* handler = (ButtonHandler*)parameter;
+    
+    Serial.printf("Keypad-Task gestartet auf Core 0 (%s)\n", handler->adcDma ? "ADC-DMA" : "analogRead");
     
-    Serial.println("Keypad-Task gestartet auf Core 0");
+    if (handler->adcDma) {
+        handler->readAdcDma();      // Kehrt nicht zurück
+    }
     
+    // Nur zum Messzeitpunkt aufwachen statt jede Millisekunde
+    TickType_t lastWake = xTaskGetTickCount();
     for (;;) {
-        int key = kp->loop();
+        handler->pollKeypad();
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(KEYPAD_MESS_INTERVAL));
+    }
+}
+
+void ButtonHandler::pollKeypad() {
+    handleKeypadResult(keypad->loop());
+}
+
+#if KEYPAD_ADC_DMA
+// Keypad-Pin (nur ADC1) im Dauerbetrieb per DMA abtasten
+bool ButtonHandler::beginAdcDma() {
+    int8_t channel = digitalPinToAnalogChannel(keypad->getPin());
+    if (channel < 0 || channel >= ADC1_CHANNEL_MAX) {
+        Serial.println("Keypad: Pin nicht an ADC1 - DMA nicht möglich, nutze analogRead");
+        return false;
+    }
+    
+    // Puffer reicht für eine Leerlaufphase plus Reserve
+    adc_digi_init_config_t init = {};
+    init.max_store_buf_size = KEYPAD_DMA_FRAME_BYTES * (KEYPAD_DMA_IDLE_MS / KEYPAD_MESS_INTERVAL + 4);
+    init.conv_num_each_intr = KEYPAD_DMA_FRAME_BYTES;
+    init.adc1_chan_mask = BIT(channel);
+    init.adc2_chan_mask = 0;
+    if (adc_digi_initialize(&init) != ESP_OK) {
+        Serial.println("Keypad: ADC-DMA Initialisierung fehlgeschlagen, nutze analogRead");
+        return false;
+    }
+    
+    adc_digi_pattern_config_t pattern = {};
+    pattern.atten = ADC_ATTEN_DB_11;        // 0-3.3V wie bei analogRead
+    pattern.channel = channel;
+    pattern.unit = 0;                       // ADC1
+    pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    
+    adc_digi_configuration_t config = {};
+    config.conv_limit_en = true;            // ESP32: Pflicht im DMA-Betrieb
+    config.conv_limit_num = 250;
+    config.pattern_num = 1;
+    config.adc_pattern = &pattern;
+    config.sample_freq_hz = KEYPAD_DMA_SAMPLE_HZ;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+    if (adc_digi_controller_configure(&config) != ESP_OK || adc_digi_start() != ESP_OK) {
+        adc_digi_deinitialize();
+        Serial.println("Keypad: ADC-DMA Start fehlgeschlagen, nutze analogRead");
+        return false;
+    }
+    
+    Serial.printf("  Keypad: ADC-DMA %d Hz, %d Werte pro Messung, Leerlauf alle %dms\n",
+                 KEYPAD_DMA_SAMPLE_HZ, KEYPAD_DMA_SAMPLES, KEYPAD_DMA_IDLE_MS);
+    return true;
+}
+
+// Keypad-Task im DMA-Betrieb: während Messung/Sperre bei jedem Block wach,
+// im Leerlauf schlafen und die aufgelaufenen Blöcke am Stück nachholen.
+// Ein Tastendruck aus der Schlafphase ist damit lückenlos im Puffer.
+void ButtonHandler::readAdcDma() {
+    uint8_t frame[KEYPAD_DMA_FRAME_BYTES];
+    
+    for (;;) {
+        uint32_t length = 0;
+        uint32_t timeout = keypad->isIdle() ? 0 : KEYPAD_MESS_INTERVAL * 2;
+        esp_err_t err = adc_digi_read_bytes(frame, sizeof(frame), &length, timeout);
         
-        // Gültige Taste erkannt (>= 0)
-        if (key >= 0) {
-            // Taste in Queue senden
-            xQueueSend(keyQueue, &key, 0);
-            
-            // LED-OK Signal senden
-            int ledCmd = 1;  // 1 = OK
-            xQueueSend(ledQueue, &ledCmd, 0);
+        if (err == ESP_ERR_TIMEOUT || length == 0) {
+            if (keypad->isIdle()) vTaskDelay(pdMS_TO_TICKS(KEYPAD_DMA_IDLE_MS));
+            continue;
         }
-        // Fehler erkannt
-        else if (key == KEYPAD_ERROR) {
-            // LED-Fehler Signal senden
-            int ledCmd = 2;  // 2 = Error
-            xQueueSend(ledQueue, &ledCmd, 0);
+        // ESP_ERR_INVALID_STATE = Puffer lief über (Blöcke fehlen) - trotzdem auswerten
+        
+        for (uint32_t i = 0; i + 1 < length; i += 2) {
+            const adc_digi_output_data_t* sample = (const adc_digi_output_data_t*)&frame[i];
+            dmaSum += sample->type1.data;
+            if (++dmaCount < KEYPAD_DMA_SAMPLES) continue;
+            
+            // Ein voller Block = eine Messung im gewohnten Raster
+            handleKeypadResult(keypad->process(dmaSum / dmaCount));
+            dmaSum = 0;
+            dmaCount = 0;
         }
-        // KEYPAD_MEASURING, KEYPAD_LOCKED, KEYPAD_NO_KEY ignorieren
+    }
+}
+#else
+bool ButtonHandler::beginAdcDma() {
+    return false;
+}
+
+void ButtonHandler::readAdcDma() {
+}
+#endif
+
+void ButtonHandler::handleKeypadResult(int key) {
+    // Gültige Taste erkannt (>= 0)
+    if (key >= 0) {
+        // Taste in Queue senden
+        xQueueSend(keyQueue, &key, 0);
         
-        vTaskDelay(1);  // Minimal delay für Watchdog
+        // LED-OK Signal senden
+        int ledCmd = 1;  // 1 = OK
+        xQueueSend(ledQueue, &ledCmd, 0);
+        
+        // Hauptloop sofort wecken statt auf dessen nächste Deadline zu warten
+        Scheduler::wake(schedulerTask);
+    }
+    // Fehler erkannt
+    else if (key == KEYPAD_ERROR) {
+        // LED-Fehler Signal senden
+        int ledCmd = 2;  // 2 = Error
+        xQueueSend(ledQueue, &ledCmd, 0);
+        Scheduler::wake(schedulerTask);
     }
+    // KEYPAD_MEASURING, KEYPAD_LOCKED, KEYPAD_NO_KEY ignorieren
 }
 
 void ButtonHandler::begin() {
@@ -583,12 +769,14 @@ void ButtonHandler::begin() {
     // Queue für LED-Befehle erstellen
     ledQueue = xQueueCreate(5, sizeof(int));
     
+    adcDma = beginAdcDma();
+    
     // Keypad-Task auf Core 0 starten (Core 1 = Arduino loop)
     xTaskCreatePinnedToCore(
         keypadTask,           // Task-Funktion
         "KeypadTask",         // Name
         4096,                 // Stack-Größe
-        keypad,               // Parameter (Keypad-Objekt)
+        this,                 // Parameter (ButtonHandler)
         2,                    // Priorität (höher = wichtiger)
         &keypadTaskHandle,    // Task-Handle
         0                     // Core 0 (nicht Core 1 wo loop() läuft)
@@ -597,6 +785,11 @@ void ButtonHandler::begin() {
     Serial.println("✓ Button Handler initialisiert (Keypad auf Core 0, RF auf Core 1, LED-Feedback aktiv)");
 }
 
+uint32_t ButtonHandler::msUntilNextUpdate() {
+    // RF wird gepollt (RCSwitch meldet Empfang nur per Flag), Keypad weckt per Notification
+    return min((uint32_t)RF_POLL_INTERVAL_MS, ledFeedback->msUntilNextUpdate());
+}
+
 void ButtonHandler::loop() {
     // LED-Feedback verarbeiten (non-blocking)
     ledFeedback->loop();
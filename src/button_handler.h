@@ -36,17 +36,33 @@ public:
     void showError();        // LED 3x blinken
     void loop();             // Im Hauptloop aufrufen
     bool isBusy();           // Gibt true zurück wenn LED noch aktiv
+    uint32_t msUntilNextUpdate();  // Bis zum nächsten Zustandswechsel (UINT32_MAX = aus)
     void setLed(bool on);    // LED direkt setzen
 };
 
 // Konstanten für die verbesserte Tastenerkennung
 #define KEYPAD_THRESHOLD 500        // Mindest-ADC-Wert für "Taste gedrückt"
-#define KEYPAD_TOLERANCE 50         // Toleranz für Ausreißer-Erkennung
+#define KEYPAD_TOLERANCE 50         // Toleranz für Ausreißer-Erkennung, Mindest-Reichweite einer Taste
 #define KEYPAD_MIN_GUETE 75.0       // Mindest-Güte in Prozent
 #define KEYPAD_RELEASE_COUNT 5      // Anzahl Messungen < threshold für "losgelassen"
 #define KEYPAD_MIN_MESSUNGEN 10     // Mindestanzahl gültiger Messungen
-#define KEYPAD_MAX_MESSUNGEN 1000   // Maximale Anzahl Messungen
+#define KEYPAD_MEDIAN_FENSTER 5     // Laufender Median über die letzten Messungen (Bezug für Ausreißer)
 #define KEYPAD_MESS_INTERVAL 10     // Intervall zwischen Messungen in ms
+#define KEYPAD_DMA_SAMPLES (KEYPAD_DMA_SAMPLE_HZ / 1000 * KEYPAD_MESS_INTERVAL)  // Abtastwerte pro Messung
+#define KEYPAD_DMA_FRAME_BYTES (KEYPAD_DMA_SAMPLES * 2)                         // 2 Byte pro Abtastwert
+
+// Entscheidungstabelle ADC-Wert -> Taste (bei Kalibrierung und nach jedem Druck neu gebaut)
+#define KEYPAD_LUT_SHIFT 2          // Ein Eintrag pro 4 ADC-Codes
+#define KEYPAD_LUT_GROESSE (4096 >> KEYPAD_LUT_SHIFT)
+#define KEYPAD_LUT_MEHRDEUTIG 0xFF  // Keiner Taste sicher zuzuordnen
+#define KEYPAD_STREUUNG_START 15.0  // Angenommene Streuung σ je Taste bis zum ersten Druck (ADC-Codes)
+#define KEYPAD_STREUUNG_MIN 5.0     // Untergrenze (DMA-Mittelwerte streuen kaum)
+#define KEYPAD_STREUUNG_MAX 30.0    // Obergrenze (eine Taste darf ihre Nachbarn nicht verdrängen)
+#define KEYPAD_LERN_Z_MAX 2.0       // Lernen nur, wenn der Mittelwert so nah an der Taste liegt (in σ)
+#define KEYPAD_LERN_Z_ABSTAND 2.0   // ... und die Nachbartaste mindestens so viel weiter weg ist (in σ)
+#define KEYPAD_STREUUNG_SCHWELLE 0.2  // Tabelle erst neu bauen, wenn sich ein σ um 20% geändert hat
+#define KEYPAD_LUT_Z_MAX 4.0        // Reichweite einer Taste in σ (mindestens KEYPAD_TOLERANCE)
+#define KEYPAD_LUT_Z_ABSTAND 0.5    // Schutzband zwischen zwei Tasten (Differenz der σ-Abstände)
 
 // Ergebnis der Tastenerkennung
 enum KeypadResult {
@@ -60,20 +76,24 @@ class AnalogKeypad {
 private:
     uint8_t pin;
     bool measuring;                 // Aktuell in Messung?
-    unsigned long lastReadTime;     // Für non-blocking Timing
     
     // Kalibrierwerte für 16 Tasten (ADC-Werte)
     int tastenWerte[NUM_KEYS];
     int anzahlTasten;
+    float tastenStreuung[NUM_KEYS];         // Gelernte Streuung σ je Taste
+    float tabellenStreuung[NUM_KEYS];       // σ, mit denen die Tabelle gebaut wurde
+    uint8_t tabelle[KEYPAD_LUT_GROESSE];    // ADC-Wert >> KEYPAD_LUT_SHIFT -> Taste
     
     // Standard-Kalibrierung (kann über setCalibration geändert werden)
     String kalibrierung;
     
-    // Messdaten
-    int messwerte[KEYPAD_MAX_MESSUNGEN];
+    // Messdaten: laufend ausgewertet, O(1) pro Messung und unabhängig von der Druckdauer
+    int fenster[KEYPAD_MEDIAN_FENSTER];     // Letzte Messwerte (Ring) für den laufenden Median
     int anzahlMessungen;
     int unterSchwellwert;
-    long summe;
+    int anzahlGueltig;              // Messwerte innerhalb KEYPAD_TOLERANCE um den Median
+    float mittelwert;               // Welford: Mittelwert der gültigen Messwerte
+    float m2;                       // Welford: Summe der Abweichungsquadrate
     
     // Neue Member für verbesserte Erkennung
     bool locked;                    // Gesperrt nach früher Erkennung
@@ -82,6 +102,11 @@ private:
     bool earlyDetected;             // Frühe Erkennung erfolgt?
     
     void parseKalibrierung();
+    void messwertAufnehmen(int wert);
+    void messungZuruecksetzen();
+    int laufenderMedian();
+    void tabelleAufbauen();
+    void streuungLernen(int taste);
     int berechneTaste();
     int berechneTasteMitGuete(float* gueteOut);  // Neue Methode mit Güte-Rückgabe
     
@@ -89,6 +114,9 @@ public:
     AnalogKeypad(uint8_t adcPin);
     void begin();
     int loop();                     // Rückgabe: Tastennummer oder KeypadResult
+    int process(int value);         // Eine Messung (Abstand KEYPAD_MESS_INTERVAL) auswerten
+    bool isIdle() { return !measuring && !locked; }
+    uint8_t getPin() { return pin; }
     KeypadResult getLastResult() { return lastResult; }
     
     // Kalibrierung setzen (Format: "1:4095,2:3697,3:3202,...")
@@ -142,11 +170,26 @@ private:
     static ButtonHandler* instance;
     static void keypadTask(void* parameter);
     void processKey(int key);
+    void handleKeypadResult(int key);
+    
+    // DMA-Betrieb (KEYPAD_ADC_DMA): Blöcke mitteln, eine Messung pro KEYPAD_DMA_SAMPLES
+    bool adcDma;
+    uint32_t dmaSum;
+    uint16_t dmaCount;
+    bool beginAdcDma();
+    void readAdcDma();
     
 public:
     ButtonHandler();
     void begin();
     void loop();
+    uint32_t msUntilNextUpdate();   // Für den Scheduler
+    
+    // Ein Abtastschritt des Keypad-Tasks (Core 0, auch von der Simulation genutzt)
+    void pollKeypad();
+    
+    // Scheduler-Task, der loop() aufruft (wird bei Tastendruck geweckt)
+    int8_t schedulerTask = -1;
     
     RFReceiver* getRFReceiver() { return rfReceiver; }
     
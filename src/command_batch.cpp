@@ -0,0 +1,84 @@
+#include "command_batch.h"
+#include <ArduinoJson.h>
+
+static bool parseEntry(JsonObject item, BatchEntry& entry, const char** error) {
+    int motor = item["motor"] | 0;
+    if (motor < 1 || motor > 4) {
+        *error = "motor muss 1-4 sein";
+        return false;
+    }
+    entry.motor = motor;
+    entry.position = 0;
+    
+    if (item.containsKey("position")) {
+        int position = item["position"] | -1;
+        if (position < 0 || position > 100) {
+            *error = "position muss 0-100 sein";
+            return false;
+        }
+        entry.action = BATCH_POSITION;
+        entry.position = position;
+        return true;
+    }
+    
+    const char* cmd = item["cmd"] | (const char*)nullptr;
+    if (!cmd) {
+        *error = "cmd oder position fehlt";
+        return false;
+    }
+    if (strcasecmp(cmd, "OPEN") == 0) {
+        entry.action = BATCH_OPEN;
+    } else if (strcasecmp(cmd, "CLOSE") == 0) {
+        entry.action = BATCH_CLOSE;
+    } else if (strcasecmp(cmd, "STOP") == 0) {
+        entry.action = BATCH_STOP;
+    } else {
+        // Position als Text wie bei /motorN/control?cmd=40
+        char* end;
+        long position = strtol(cmd, &end, 10);
+        if (end == cmd || *end != '\0' || position < 0 || position > 100) {
+            *error = "unbekannter cmd";
+            return false;
+        }
+        entry.action = BATCH_POSITION;
+        entry.position = position;
+    }
+    return true;
+}
+
+bool parseCommandBatch(const char* json, size_t length, CommandBatch& batch, const char** error) {
+    batch.count = 0;
+    
+    StaticJsonDocument<1024> doc;
+    DeserializationError err = deserializeJson(doc, json, length);
+    if (err) {
+        *error = "ungültiges JSON";
+        return false;
+    }
+    
+    JsonArray list = doc.as<JsonArray>();
+    if (list.isNull() || list.size() == 0) {
+        *error = "JSON-Array mit Befehlen erwartet";
+        return false;
+    }
+    if (list.size() > BATCH_MAX_ENTRIES) {
+        *error = "zu viele Befehle";
+        return false;
+    }
+    
+    for (JsonObject item : list) {
+        if (item.isNull()) {
+            *error = "Befehl muss ein Objekt sein";
+            return false;
+        }
+        BatchEntry entry;
+        if (!parseEntry(item, entry, error)) return false;
+        
+        // Motor mehrfach genannt: der letzte Eintrag gilt (ersetzt den früheren)
+        uint8_t i = 0;
+        while (i < batch.count && batch.entries[i].motor != entry.motor) i++;
+        batch.entries[i] = entry;
+        if (i == batch.count) batch.count++;
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef COMMAND_BATCH_H
+#define COMMAND_BATCH_H
+
+#include <Arduino.h>
+
+#define BATCH_MAX_ENTRIES 8
+#define BATCH_JSON_MAX 512              // Größter akzeptierter Batch (Web-Body / MQTT-Payload)
+
+enum BatchAction : uint8_t {
+    BATCH_OPEN,
+    BATCH_CLOSE,
+    BATCH_STOP,
+    BATCH_POSITION
+};
+
+struct BatchEntry {
+    uint8_t motor;                  // 1-4
+    BatchAction action;
+    uint8_t position;               // % (nur BATCH_POSITION)
+};
+
+// Mehrere Motorbefehle, die im selben Durchlauf des Motor-Tasks gestartet werden
+// (Szenen: alle Motoren gleichzeitig, Richtungsblöcke wie bei der Arbitrierung)
+struct CommandBatch {
+    uint8_t count;
+    BatchEntry entries[BATCH_MAX_ENTRIES];
+};
+
+// [{"motor":1,"cmd":"OPEN"},{"motor":2,"position":40},{"motor":3,"cmd":"STOP"}]
+// "cmd" darf auch eine Position sein ("40"). Nennt der Batch einen Motor mehrfach,
+// gilt der letzte Eintrag. Bei Fehler false und Text in *error; der Batch wird
+// dann als Ganzes verworfen.
+bool parseCommandBatch(const char* json, size_t length, CommandBatch& batch, const char** error);
+
+#endif
@@ -0,0 +1,60 @@
+#include "command_queue.h"
+#include "scheduler.h"
+
+CommandQueue::Slot CommandQueue::slots[COMMAND_QUEUE_SIZE];
+uint32_t CommandQueue::enqueuePos = 0;
+uint32_t CommandQueue::dequeuePos = 0;
+uint32_t CommandQueue::dropped = 0;
+int8_t CommandQueue::consumerTask = -1;
+
+void CommandQueue::begin() {
+    for (uint32_t i = 0; i < COMMAND_QUEUE_SIZE; i++) {
+        slots[i].sequence = i;
+    }
+    enqueuePos = 0;
+    dequeuePos = 0;
+}
+
+bool CommandQueue::post(const ControlCommand& command) {
+    uint32_t pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+    Slot* slot;
+    
+    for (;;) {
+        slot = &slots[pos & (COMMAND_QUEUE_SIZE - 1)];
+        uint32_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+        
+        if (diff == 0) {
+            // Platz frei: reservieren (bei Konkurrenz enthält pos danach den neuen Stand)
+            if (__atomic_compare_exchange_n(&enqueuePos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Leser hat den Platz noch nicht abgeholt: voll
+            __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+            Serial.println("Befehlsqueue voll - Befehl verworfen");
+            return false;
+        } else {
+            pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+    
+    slot->command = command;
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+    Scheduler::wake(consumerTask);
+    return true;
+}
+
+bool CommandQueue::take(ControlCommand& command) {
+    Slot& slot = slots[dequeuePos & (COMMAND_QUEUE_SIZE - 1)];
+    uint32_t seq = __atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE);
+    
+    // Reserviert, aber noch nicht fertig kopiert (oder leer): beim nächsten Wake
+    if (seq != dequeuePos + 1) return false;
+    
+    command = slot.command;
+    __atomic_store_n(&slot.sequence, dequeuePos + COMMAND_QUEUE_SIZE, __ATOMIC_RELEASE);
+    dequeuePos++;
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <Arduino.h>
+#include "command_batch.h"
+
+#define COMMAND_QUEUE_SIZE 16           // Zweierpotenz; Befehle bis zum nächsten Durchlauf des Motor-Tasks
+#define COMMAND_ARG_MAX 16              // "OPEN", "100", "cancel"
+
+enum ControlCommandType : uint8_t {
+    CONTROL_MOVE,                   // arg: "OPEN", "CLOSE", "STOP" oder Position "0"-"100"
+    CONTROL_LEARN,                  // arg: "open", "close", "finish", "cancel", "auto"
+    CONTROL_BATCH                   // batch: mehrere Motoren gemeinsam
+};
+
+struct ControlCommand {
+    ControlCommandType type;
+    uint8_t motor;                  // 1-4, 0 = alle Motoren
+    union {
+        char arg[COMMAND_ARG_MAX];
+        CommandBatch batch;
+    };
+};
+
+// Einziger Eingang in die Motorsteuerung: Web (AsyncTCP-Task), MQTT-Task und
+// Tasten/RF posten hierher, nur der Motor-Task im Hauptloop führt aus.
+// Lock-freier Ringpuffer für mehrere Schreiber und einen Leser: Schreiber
+// reservieren einen Platz per CAS auf enqueuePos, die Sequenznummer des Platzes
+// gibt ihn erst nach dem Kopieren für den Leser frei.
+class CommandQueue {
+private:
+    struct Slot {
+        uint32_t sequence;          // == Position: frei, == Position + 1: belegt
+        ControlCommand command;
+    };
+    
+    static Slot slots[COMMAND_QUEUE_SIZE];
+    static uint32_t enqueuePos;     // Schreiber (atomar)
+    static uint32_t dequeuePos;     // Nur der Leser
+    static uint32_t dropped;        // Verworfen, weil voll (atomar)
+    
+public:
+    static void begin();            // Aus setup() vor allen Eingängen aufrufen
+    
+    static int8_t consumerTask;     // Scheduler-Task, der bei jedem Befehl geweckt wird
+    
+    // Aus beliebigem Task, blockiert nie. false = Queue voll, Befehl verworfen
+    static bool post(const ControlCommand& command);
+    
+    // Nur im Motor-Task: nächsten Befehl in Eingangsreihenfolge holen
+    static bool take(ControlCommand& command);
+    
+    static uint32_t getDropped() { return __atomic_load_n(&dropped, __ATOMIC_RELAXED); }
+};
+
+#endif
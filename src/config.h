@@ -17,19 +17,39 @@
 #define MQTT_USER "bossi"
 #define MQTT_PASSWORD "bigboss1"
 #define MQTT_TOPIC_PREFIX "velux"
+#define MQTT_RECONNECT_MIN_MS 1000         // Backoff nach dem ersten Fehlversuch
+#define MQTT_RECONNECT_MAX_MS 60000        // Obergrenze (verdoppelt sich je Fehlversuch)
+#define MQTT_EVENT_PERSIST false           // Ereignisse während Broker-Ausfall im NVS sichern (überleben Neustart)
+#define MQTT_EVENT_PERSIST_INTERVAL_MS 60000   // Während eines Ausfalls höchstens so oft ins NVS schreiben
+
+// Home Assistant MQTT Discovery (ein cover-Entity pro Motor, retained)
+#define HA_DISCOVERY_ENABLED true
+#define HA_DISCOVERY_PREFIX "homeassistant"
+#define HA_DEVICE_NAME "Velux Controller"
+#define HA_COVER_NAME "Rollladen"          // Entity-Name: "Rollladen 1" ... "Rollladen 4"
 
 // ===== Motor Pins (4x BTS7960 - OPTIMIERT) =====
-// PWM-Pins (gemeinsam für alle Motoren)
+// PWM-Verdrahtung:
+//   false = RPWM/LPWM aller Treiber gemeinsam an RPWM_ALL/LPWM_ALL, Motorwahl über
+//           die Enable-Pins. Nur eine Richtung gleichzeitig, eine Rampe für alle.
+//   true  = eigenes LEDC-Kanalpaar pro Motor: RPWM/LPWM jedes Treibers an dessen
+//           Mx_R_EN/Mx_L_EN-GPIO, R_EN/L_EN fest auf 3,3V. Gemischte Richtungen
+//           parallel, jeder Motor mit eigenem Sanftanlauf.
+#ifndef PWM_PER_MOTOR
+#define PWM_PER_MOTOR false
+#endif
+
+// PWM-Pins (gemeinsam für alle Motoren, nur PWM_PER_MOTOR false)
 #define RPWM_ALL 25
 #define LPWM_ALL 26
-#define RPWM_CHANNEL 0
+#define RPWM_CHANNEL 0                  // PWM_PER_MOTOR: Motor n nutzt Kanal 2(n-1) / 2(n-1)+1
 #define LPWM_CHANNEL 1
 
 // Relais für Motorstromversorgung
 #define MOTOR_POWER_RELAY_PIN 23
 #define RELAY_ACTIVE_LOW true           // true = LOW schaltet Relais EIN (invertiert)
 #define RELAY_PRE_ON_DELAY_MS 300      // Relais schaltet 300ms VOR Motoren ein
-#define RELAY_POST_OFF_DELAY_MS 20000  // Relais schaltet 20s NACH letztem Motor aus
+#define RELAY_POST_OFF_DELAY_MS 20000UL  // Relais schaltet 20s NACH letztem Motor aus
 
 // Enable-Pins (Paare liegen nebeneinander)
 #define M1_R_EN 32
@@ -42,7 +62,9 @@
 #define M4_L_EN 19
 
 // ===== INA219 Stromsensoren =====
+#ifndef INA219_ENABLED
 #define INA219_ENABLED false  // Auf true setzen wenn INA219 angeschlossen
+#endif
 
 #define INA219_ADDR_M1 0x40
 #define INA219_ADDR_M2 0x41
@@ -52,7 +74,31 @@
 // Überstromschutz
 #define MAX_CURRENT_MA 3000.0     // 3A Maximum
 #define OVERCURRENT_TIME_MS 500    // Überstrom für 500ms = Abschaltung
-#define CURRENT_CHECK_INTERVAL 100 // Stromprüfung alle 100ms
+#define CURRENT_CHECK_INTERVAL 20  // Sampler-Werte alle 20ms abholen und prüfen
+
+// Abtastung (eigener Task auf Core 0, alle Sensoren nacheinander)
+#define CURRENT_SAMPLE_PERIOD_MS 2     // 4 Sensoren alle 2ms = 2 kHz gesamt
+#define CURRENT_FILTER_ALPHA 0.2f      // Gleitender Mittelwert pro Motor
+#define INA219_I2C_CLOCK 400000        // Fast-Mode I2C
+
+// Endlagenerkennung über die Stromsignatur (nur mit INA219)
+#define ENDSTOP_DETECTION_ENABLED true
+#define ENDSTOP_MIN_RUN_MA 100.0       // Ab hier gilt der Motor als bestromt
+#define ENDSTOP_BLANKING_MS 250        // Anlaufstrom danach ignorieren
+#define ENDSTOP_BASELINE_ALPHA 0.01f   // Plateau-Nachführung pro Messwert (~200ms bei 500 Hz)
+#define ENDSTOP_CUSUM_K_MA 150.0       // Erlaubte Abweichung über dem Plateau pro Messwert
+#define ENDSTOP_CUSUM_H_MA 3000.0      // Alarmschwelle der aufsummierten Abweichung
+#define ENDSTOP_PLATEAU_MA 600.0       // Strom muss so weit über dem Plateau liegen
+#define ENDSTOP_SLOPE_WINDOW 8         // Messwerte für die Steigung (Einzelspitzen fallen wieder)
+#define ENDSTOP_RESYNC_WINDOW 15       // Nur so nah an der geschätzten Endlage auf 0/100% setzen (%)
+#define ENDSTOP_OVERRUN_PERCENT 15     // Ohne Erkennung max. so weit über die Schätzung hinaus fahren (% Fahrzeit)
+#define ENDSTOP_STALL_START_RATIO 0.9f // Strom nach dem Ausblenden noch so nah am Anlaufspitzenwert: blockiert ab Start
+
+// Automatische Kalibrierung (braucht INA219 und Endlagenerkennung)
+#define AUTO_CAL_RUNS 3                // Läufe 0->100->0%, Fahrzeiten werden gemittelt
+#define AUTO_CAL_MAX_RUNS 10
+#define AUTO_CAL_MIN_TRAVEL_MS 2000    // Kürzere Lernfahrt = Fehlmessung (Endlage nicht verlassen)
+#define AUTO_CAL_MAX_SPREAD 5          // Warnung, wenn die Läufe weiter streuen (% vom Mittelwert)
 
 // ===== Analoges Keypad (16 Tasten an einem ADC-Pin) =====
 #define KEYPAD_PIN 34
@@ -78,19 +124,49 @@
 
 // ===== Webserver =====
 #define WEB_SERVER_PORT 80
+#define WEB_EVENT_INTERVAL_MS 100      // /events: Position während der Fahrt höchstens 10x/s
+// Oberfläche ("/"): ein Tag aus dem Browser-Cache, danach 304 per ETag.
+// Nach einem OTA-Update ggf. neu laden (Strg+F5), falls der Cache noch gilt.
+#define WEB_UI_CACHE_CONTROL "public, max-age=86400"
 
 // ===== Motor Settings =====
 #define PWM_FREQ 1000
 #define PWM_RESOLUTION 8
 #define MAX_RUNTIME_MS 120000
 #define POSITION_UPDATE_INTERVAL 100
+#define STOP_INERTIA_MS 40             // Nachlauf nach Abschalten (Startwert, pro Motor gelernt)
+#define STOP_INERTIA_MAX_MS 500        // Obergrenze des gelernten Nachlaufs
+#define STOP_INERTIA_ADAPT_PERCENT 25  // Anteil der gemessenen Abweichung pro Endlagen-Fahrt
+#define ARBITRATION_DEADLINE_MS 10000  // Vorgemerkte Gegenrichtung: danach keine neuen Starts der laufenden Richtung
 
 // ===== Sanftanlauf =====
 #define SOFT_START_ENABLED true
 #define SOFT_START_DURATION_MS 2000
 #define SOFT_START_MIN_PWM 100
 #define SOFT_START_MAX_PWM 255
-#define SOFT_START_STEP_INTERVAL 50
+#define SOFT_START_STEP_INTERVAL 50     // Nur ohne esp_timer: Rampenschritt aus dem Hauptloop
+#define SOFT_START_CURVE RAMP_LINEAR    // RAMP_LINEAR, RAMP_SCURVE, RAMP_EXPONENTIAL, RAMP_LEARNED
+#define RAMP_TABLE_SIZE 64              // Stützstellen pro Rampentabelle (dazwischen linear)
+#define RAMP_STEP_MS 2                  // Rampen-Timer (esp_timer), 1-5ms
+#define RAMP_EXP_FACTOR 4.0             // Steilheit der Exponential-Rampe
+
+// ===== Sanftstopp =====
+#define SOFT_STOP_ENABLED true          // PWM vor dem Abschalten auf 0 rampen (nur allein am Ausgang)
+#define SOFT_STOP_DURATION_MS 400       // Dauer ab voller PWM
+
+// ===== Fahrzeitmodell =====
+// Geschwindigkeit aus dem anliegenden Tastgrad und dem Laststrom; openTime/closeTime
+// gelten bei voller PWM und dem Referenzstrom der gelernten Fahrt
+#define KINEMATIC_DEADBAND_PWM 51       // Darunter läuft der Motor nicht (Haftreibung, ~20% Tastgrad)
+#define KINEMATIC_LOAD_GAIN 1.0f        // Geschwindigkeitsabfall pro relativer Stromzunahme (1.0 = v ~ 1/I)
+#define KINEMATIC_LOAD_SAMPLES 50       // Mittelwert daraus korrigiert den Weg seit Fahrtbeginn
+#define KINEMATIC_LOAD_ALPHA 0.02f      // Danach Lastfilter pro Messwert (nur bei voller PWM)
+#define KINEMATIC_SETTLE_INERTIA 5      // Laststrom frühestens nach so vielen Nachlauf-Zeiten bei voller PWM
+#define KINEMATIC_SCALE_MIN 0.5f        // Grenzen des Lastfaktors
+#define KINEMATIC_SCALE_MAX 1.5f
+#define KINEMATIC_ADAPT_PERCENT 75      // Nachführung der Fahrzeit pro Fahrt von Endlage zu Endlage
+#define KINEMATIC_ADAPT_LIMIT 20        // Größere Abweichung (%) gilt als Fehlmessung
+#define KINEMATIC_REPLAN_PERCENT 2      // Stopp-Timer neu planen, wenn sich der Lastfaktor so weit ändert
 
 // ===== LED-Feedback =====
 #define LED_FEEDBACK_PIN 2             // GPIO für Feedback-LED
@@ -107,6 +183,25 @@
 #define KEYPAD_MAX_ATTEMPTS 100        // Max Messungen bevor Fehler
 #define KEYPAD_FINAL_GUETE 75.0        // Mindest-Güte nach 100 Messungen (%)
 
+// Keypad-ADC im DMA-Betrieb: der ADC tastet durchgehend ab, jede Messung ist
+// der Mittelwert eines Blocks. Im Leerlauf schläft der Task und holt die
+// aufgelaufenen Blöcke nur alle KEYPAD_DMA_IDLE_MS ab (ohne Abtastlücke).
+#ifndef KEYPAD_ADC_DMA
+#define KEYPAD_ADC_DMA true            // false = analogRead alle KEYPAD_MESS_INTERVAL ms
+#endif
+#define KEYPAD_DMA_SAMPLE_HZ 20000     // Abtastrate (Minimum des ESP32-DMA-Betriebs)
+#define KEYPAD_DMA_IDLE_MS 50          // Leerlauf: Blöcke nur so oft abholen
+
+// ===== Scheduler (Hauptloop) =====
+#define SCHEDULER_MAX_SLEEP_MS 1000    // Längste Schlafphase ohne Ereignis
+#define RF_POLL_INTERVAL_MS 20         // RCSwitch-Empfangsflag abfragen
+#define MQTT_POLL_INTERVAL_MS 20       // MQTT-Task: PubSubClient::loop() (eingehende Nachrichten)
+#define OTA_POLL_INTERVAL_MS 100       // ArduinoOTA.handle()
+#define STATUS_MOVING_INTERVAL_MS 250  // MQTT-Status während der Fahrt (nur bei Änderung)
+#define STATUS_HEARTBEAT_MS 60000      // MQTT-Status im Stillstand ohne Änderung
+#define STATUS_CURRENT_DELTA_MA 50     // Stromänderung, ab der neu gesendet wird
+#define SNAPSHOT_SYSTEM_INTERVAL_MS 10000  // Heap-Werte in /status
+
 // ===== EEPROM =====
 #define PREFS_NAMESPACE "velux"
 
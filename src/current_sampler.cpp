@@ -0,0 +1,96 @@
+#include "current_sampler.h"
+#include "config.h"
+#include <Wire.h>
+
+Adafruit_INA219* CurrentSampler::sensors[CURRENT_MAX_SENSORS];
+CurrentRing CurrentSampler::rings[CURRENT_MAX_SENSORS];
+uint8_t CurrentSampler::sensorCount = 0;
+TaskHandle_t CurrentSampler::taskHandle = nullptr;
+
+int8_t CurrentSampler::addSensor(uint8_t address) {
+    if (sensorCount >= CURRENT_MAX_SENSORS) return -1;
+    
+    Adafruit_INA219* ina = new Adafruit_INA219(address);
+    if (!ina->begin()) {
+        delete ina;
+        return -1;
+    }
+    
+    int8_t channel = sensorCount++;
+    sensors[channel] = ina;
+    rings[channel].head = 0;
+    rings[channel].tail = 0;
+    return channel;
+}
+
+void CurrentSampler::begin() {
+    if (sensorCount == 0) {
+        Serial.println("Strommessung: Keine INA219 - Sampler-Task nicht gestartet");
+        return;
+    }
+    
+    // Alle Sensoren hängen am selben Bus: schneller Takt hält eine Runde kurz
+    Wire.setClock(INA219_I2C_CLOCK);
+    
+    // Sampler-Task auf Core 0 (Core 1 = Arduino loop)
+    xTaskCreatePinnedToCore(
+        samplerTask,          // Task-Funktion
+        "CurrentTask",        // Name
+        3072,                 // Stack-Größe
+        nullptr,              // Parameter
+        3,                    // Priorität (über Keypad: feste Abtastrate)
+        &taskHandle,          // Task-Handle
+        0                     // Core 0
+    );
+    
+    Serial.printf("Strommessung: %d INA219 alle %dms (%d Hz gesamt) auf Core 0\n",
+                 sensorCount, CURRENT_SAMPLE_PERIOD_MS, sensorCount * 1000 / CURRENT_SAMPLE_PERIOD_MS);
+}
+
+void CurrentSampler::samplerTask(void* parameter) {
+    (void)parameter;
+    TickType_t lastWake = xTaskGetTickCount();
+    
+    for (;;) {
+        sampleAll();
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(CURRENT_SAMPLE_PERIOD_MS));
+    }
+}
+
+void CurrentSampler::sampleAll() {
+    for (uint8_t i = 0; i < sensorCount; i++) {
+        CurrentRing& ring = rings[i];
+        
+        CurrentSample sample;
+        sample.current_mA = sensors[i]->getCurrent_mA();
+        sample.timeUs = micros();
+        
+        // Voll: neuester Wert entfällt (Leser holt nicht ab, z.B. Motor steht)
+        uint32_t head = ring.head;
+        uint32_t tail = __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE);
+        if (head - tail >= CURRENT_RING_SIZE) continue;
+        
+        ring.samples[head & (CURRENT_RING_SIZE - 1)] = sample;
+        __atomic_store_n(&ring.head, head + 1, __ATOMIC_RELEASE);
+    }
+}
+
+bool CurrentSampler::read(int8_t channel, CurrentSample* sample) {
+    if (channel < 0 || channel >= sensorCount) return false;
+    CurrentRing& ring = rings[channel];
+    
+    uint32_t tail = ring.tail;
+    uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+    if (tail == head) return false;
+    
+    *sample = ring.samples[tail & (CURRENT_RING_SIZE - 1)];
+    __atomic_store_n(&ring.tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Leser verwirft alles Aufgelaufene (z.B. bei Fahrtbeginn)
+void CurrentSampler::flush(int8_t channel) {
+    if (channel < 0 || channel >= sensorCount) return;
+    CurrentRing& ring = rings[channel];
+    __atomic_store_n(&ring.tail, __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
@@ -0,0 +1,46 @@
+#ifndef CURRENT_SAMPLER_H
+#define CURRENT_SAMPLER_H
+
+#include <Arduino.h>
+#include <Adafruit_INA219.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define CURRENT_MAX_SENSORS 4
+#define CURRENT_RING_SIZE 64            // Zweierpotenz, reicht für > 100ms bei 500 Hz
+
+struct CurrentSample {
+    uint32_t timeUs;
+    float current_mA;                   // Vorzeichenbehaftet (Schließen = negativ)
+};
+
+// Lock-freier Ringpuffer: genau ein Schreiber (Sampler-Task) und ein Leser (Motor-Loop).
+// head schreibt nur der Sampler, tail nur der Leser.
+struct CurrentRing {
+    CurrentSample samples[CURRENT_RING_SIZE];
+    uint32_t head;
+    uint32_t tail;
+};
+
+// Liest alle INA219 nacheinander in einem eigenen Task auf Core 0 -
+// kein I2C mehr im Hauptloop
+class CurrentSampler {
+private:
+    static Adafruit_INA219* sensors[CURRENT_MAX_SENSORS];
+    static CurrentRing rings[CURRENT_MAX_SENSORS];
+    static uint8_t sensorCount;
+    static TaskHandle_t taskHandle;
+    
+    static void samplerTask(void* parameter);
+    
+public:
+    static int8_t addSensor(uint8_t address);   // -1 = Sensor nicht gefunden
+    static void begin();                        // Task starten (nach allen addSensor)
+    static void sampleAll();                    // Eine Runde über alle Sensoren
+    
+    static bool read(int8_t channel, CurrentSample* sample);
+    static void flush(int8_t channel);
+    static uint8_t getSensorCount() { return sensorCount; }
+};
+
+#endif
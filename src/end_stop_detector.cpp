@@ -0,0 +1,85 @@
+#include "end_stop_detector.h"
+
+EndStopDetector::EndStopDetector() {
+    reset();
+}
+
+void EndStopDetector::reset() {
+    baseline = 0.0;
+    cusum = 0.0;
+    running = false;
+    triggered = false;
+    runStartUs = 0;
+    onsetUs = 0;
+    peak = 0.0;
+    blankingDone = false;
+    windowIndex = 0;
+    windowCount = 0;
+}
+
+float EndStopDetector::getSlope() {
+    if (windowCount < 2) return 0.0;
+    
+    uint8_t newest = (windowIndex + ENDSTOP_SLOPE_WINDOW - 1) % ENDSTOP_SLOPE_WINDOW;
+    uint8_t oldest = (windowCount < ENDSTOP_SLOPE_WINDOW) ? 0 : windowIndex;
+    uint32_t dt = windowTime[newest] - windowTime[oldest];
+    if (dt == 0) return 0.0;
+    
+    return (window[newest] - window[oldest]) * 1000.0 / dt;
+}
+
+bool EndStopDetector::update(uint32_t timeUs, float current_mA) {
+    if (triggered) return false;
+    
+    float x = abs(current_mA);
+    
+    window[windowIndex] = x;
+    windowTime[windowIndex] = timeUs;
+    windowIndex = (windowIndex + 1) % ENDSTOP_SLOPE_WINDOW;
+    if (windowCount < ENDSTOP_SLOPE_WINDOW) windowCount++;
+    
+    // Warten, bis der Motor Strom zieht (Relais-Vorlauf, Sanftanlauf-Beginn)
+    if (!running) {
+        if (x < ENDSTOP_MIN_RUN_MA) return false;
+        running = true;
+        runStartUs = timeUs;
+        baseline = x;
+        return false;
+    }
+    
+    // Anlaufstrom ausblenden: Plateau schnell einschwingen lassen
+    if (timeUs - runStartUs < (uint32_t)ENDSTOP_BLANKING_MS * 1000UL) {
+        baseline += (x - baseline) * 0.1;
+        peak = max(peak, x);
+        return false;
+    }
+    
+    // Erster Wert nach dem Ausblenden: ein frei laufender Motor ist vom Anlaufspitzenwert
+    // aufs Plateau gefallen, ein blockierter zieht weiter Blockierstrom
+    if (!blankingDone) {
+        blankingDone = true;
+        if (x >= peak * ENDSTOP_STALL_START_RATIO && getSlope() >= 0.0) {
+            onsetUs = runStartUs;
+            triggered = true;
+            return true;
+        }
+    }
+    
+    float previous = cusum;
+    cusum = max(0.0f, cusum + (x - baseline - (float)ENDSTOP_CUSUM_K_MA));
+    if (previous == 0.0 && cusum > 0.0) {
+        onsetUs = timeUs;
+    }
+    
+    // Plateau nur ohne laufenden Anstieg nachführen (Endlage nicht "wegmitteln")
+    if (cusum == 0.0) {
+        baseline += (x - baseline) * ENDSTOP_BASELINE_ALPHA;
+    }
+    
+    if (cusum > ENDSTOP_CUSUM_H_MA && x - baseline > ENDSTOP_PLATEAU_MA && getSlope() >= 0.0) {
+        triggered = true;
+        return true;
+    }
+    
+    return false;
+}
@@ -0,0 +1,45 @@
+#ifndef END_STOP_DETECTOR_H
+#define END_STOP_DETECTOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Erkennt das Auflaufen auf die Endlage an der Stromsignatur:
+// Plateau (Laststrom) wird langsam nachgeführt, ein CUSUM-Test summiert
+// Abweichungen nach oben. Alarm, wenn die Summe die Schwelle überschreitet,
+// der Strom deutlich über dem Plateau bleibt und nicht schon wieder fällt
+// (Steigung über ein kurzes Fenster) - so lösen Einzelspitzen nicht aus.
+// Steht der Motor schon beim Anlauf an der Endlage, fällt der Strom nach dem
+// Ausblenden nicht vom Anlaufspitzenwert ab - das gilt ebenfalls als Endlage.
+class EndStopDetector {
+private:
+    float baseline;                 // Plateau während der Fahrt (mA)
+    float cusum;                    // Aufsummierte Abweichung über baseline + k
+    bool running;                   // Motor bestromt (Strom über ENDSTOP_MIN_RUN_MA gesehen)
+    bool triggered;
+    uint32_t runStartUs;
+    uint32_t onsetUs;               // Beginn des Anstiegs, der ausgelöst hat (CUSUM verlässt 0)
+    float peak;                     // Anlaufspitzenwert während des Ausblendens
+    bool blankingDone;
+    
+    // Fenster für die Steigung
+    float window[ENDSTOP_SLOPE_WINDOW];
+    uint32_t windowTime[ENDSTOP_SLOPE_WINDOW];
+    uint8_t windowIndex;
+    uint8_t windowCount;
+    
+public:
+    EndStopDetector();
+    
+    void reset();
+    bool update(uint32_t timeUs, float current_mA);     // true = Endlage erkannt
+    
+    float getBaseline() { return baseline; }
+    float getCusum() { return cusum; }
+    float getSlope();                                   // mA/ms über das Fenster
+    bool isTriggered() { return triggered; }
+    uint32_t getRunTimeUs() { return onsetUs - runStartUs; }   // Bestromt bis Endlage (nach Auslösung)
+    uint32_t getOnsetUs() { return onsetUs; }
+};
+
+#endif
@@ -1,12 +1,17 @@
 #include <Arduino.h>
 #include <WiFi.h>
-#include <ArduinoJson.h>
 #include <ArduinoOTA.h>
+#include <esp_heap_caps.h>
 #include "config.h"
 #include "motor_controller.h"
 #include "button_handler.h"
 #include "mqtt_handler.h"
 #include "web_server.h"
+#include "scheduler.h"
+#include "current_sampler.h"
+#include "command_batch.h"
+#include "command_queue.h"
+#include "status_snapshot.h"
 
 // Globale Objekte
 MotorController* motor1;
@@ -18,7 +23,9 @@ ButtonHandler* buttons;
 MQTTHandler* mqtt;
 WebServerHandler* webserver;
 
-unsigned long lastStatusUpdate = 0;
+// Scheduler-Tasks im Hauptloop
+int8_t motorTask = -1;
+int8_t buttonTask = -1;
 
 // WiFi Connect
 void connectWiFi() {
@@ -75,57 +82,41 @@ void setupOTA() {
     Serial.println("✓ OTA aktiviert");
 }
 
-// Status JSON generieren
-String getStatusJson() {
-    StaticJsonDocument<1536> doc;
-    
-    JsonObject m1 = doc["motor1"].to<JsonObject>();
-    m1["position"] = motor1->getPosition();
-    m1["calibrated"] = motor1->getCalibrated();
-    m1["state"] = motor1->getState();
-    m1["current"] = motor1->getCurrent();
-    m1["overcurrent"] = motor1->hasOvercurrent();
-    
-    JsonObject m2 = doc["motor2"].to<JsonObject>();
-    m2["position"] = motor2->getPosition();
-    m2["calibrated"] = motor2->getCalibrated();
-    m2["state"] = motor2->getState();
-    m2["current"] = motor2->getCurrent();
-    m2["overcurrent"] = motor2->hasOvercurrent();
-    
-    JsonObject m3 = doc["motor3"].to<JsonObject>();
-    m3["position"] = motor3->getPosition();
-    m3["calibrated"] = motor3->getCalibrated();
-    m3["state"] = motor3->getState();
-    m3["current"] = motor3->getCurrent();
-    m3["overcurrent"] = motor3->hasOvercurrent();
-    
-    JsonObject m4 = doc["motor4"].to<JsonObject>();
-    m4["position"] = motor4->getPosition();
-    m4["calibrated"] = motor4->getCalibrated();
-    m4["state"] = motor4->getState();
-    m4["current"] = motor4->getCurrent();
-    m4["overcurrent"] = motor4->hasOvercurrent();
-    
-    String output;
-    serializeJson(doc, output);
-    return output;
+// Heap-Zustand: Fragmentierung = Anteil des freien Heaps außerhalb des größten Blocks
+SystemStatus getSystemStatus() {
+    SystemStatus status;
+    status.heapFree = ESP.getFreeHeap();
+    status.heapMinFree = ESP.getMinFreeHeap();
+    status.heapMaxBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    status.heapFragmentation = status.heapFree > 0
+        ? 100 - (uint8_t)((uint64_t)status.heapMaxBlock * 100 / status.heapFree) : 0;
+    status.uptime = millis() / 1000;
+    return status;
+}
+
+MotorSnapshot getMotorSnapshot(MotorController* motor) {
+    MotorSnapshot snapshot;
+    snapshot.position = motor->getPosition();
+    snapshot.state = motor->getState();
+    snapshot.current = (int16_t)motor->getCurrent();
+    snapshot.calibrated = motor->getCalibrated();
+    snapshot.overcurrent = motor->hasOvercurrent();
+    snapshot.queued = motor->isQueued();
+    snapshot.calibrating = motor->isAutoCalibrating();
+    return snapshot;
 }
 
 // Motor Command Handler
 void handleMotorCommand(MotorController* motor, const char* cmd) {
-    String command = String(cmd);
-    command.toUpperCase();
-    
-    if (command == "OPEN") {
+    if (strcasecmp(cmd, "OPEN") == 0) {
         motor->open();
-    } else if (command == "CLOSE") {
+    } else if (strcasecmp(cmd, "CLOSE") == 0) {
         motor->close();
-    } else if (command == "STOP") {
+    } else if (strcasecmp(cmd, "STOP") == 0) {
         motor->stop();
     } else {
         // Position (0-100)
-        int pos = command.toInt();
+        int pos = atoi(cmd);
         if (pos >= 0 && pos <= 100) {
             motor->moveToPosition(pos);
         }
@@ -134,13 +125,106 @@ void handleMotorCommand(MotorController* motor, const char* cmd) {
 
 // Learn Handler
 void handleLearn(MotorController* motor, const char* type) {
-    String learnType = String(type);
-    learnType.toLowerCase();
-    
-    if (learnType == "open") {
+    if (strcasecmp(type, "open") == 0) {
         motor->startLearnOpen();
-    } else if (learnType == "close") {
+    } else if (strcasecmp(type, "close") == 0) {
         motor->startLearnClose();
+    } else if (strcasecmp(type, "finish") == 0) {
+        motor->finishLearn();
+    } else if (strcasecmp(type, "cancel") == 0) {
+        motor->cancelLearn();
+    } else if (strcasecmp(type, "auto") == 0) {
+        motor->startAutoCalibration();
+    }
+}
+
+// Alle Motoren gleichzeitig (z.B. "auto": parallele Kalibrierung)
+void handleLearnAll(const char* type) {
+    handleLearn(motor1, type);
+    handleLearn(motor2, type);
+    handleLearn(motor3, type);
+    handleLearn(motor4, type);
+}
+
+// Befehl einreihen (aus beliebigem Task); ausgeführt im nächsten Durchlauf des Motor-Tasks
+bool postCommand(ControlCommandType type, uint8_t motor, const char* arg) {
+    ControlCommand command;
+    command.type = type;
+    command.motor = motor;
+    strlcpy(command.arg, arg, sizeof(command.arg));
+    return CommandQueue::post(command);
+}
+
+bool postBatch(const CommandBatch& batch) {
+    ControlCommand command;
+    command.type = CONTROL_BATCH;
+    command.motor = 0;
+    command.batch = batch;
+    return CommandQueue::post(command);
+}
+
+// Batch ausführen: erst Stopps, dann die Fahrten als Richtungsblöcke - der Block
+// mit der kürzeren Fahrzeit zuerst, wie bei der Richtungs-Arbitrierung. Bei
+// gemeinsamer PWM merkt sich der zweite Block vor und folgt geschlossen.
+// Motoren, die schon am Ziel stehen, werden nicht gestartet (sie würden sonst
+// vor dem ersten Block die gemeinsame PWM belegen).
+void applyBatch(const CommandBatch& batch) {
+    MotorController* motors[4] = {motor1, motor2, motor3, motor4};
+    MotorDirection dirs[BATCH_MAX_ENTRIES];
+    uint32_t blockTime[3] = {0, 0, 0};          // Index = MotorDirection
+    
+    Serial.printf("Batch: %d Befehle\n", batch.count);
+    
+    for (uint8_t i = 0; i < batch.count; i++) {
+        const BatchEntry& e = batch.entries[i];
+        MotorController* m = motors[e.motor - 1];
+        if (e.action == BATCH_STOP) {
+            m->stop();
+            dirs[i] = DIR_STOP;
+            continue;
+        }
+        uint8_t target = (e.action == BATCH_OPEN) ? 100 : (e.action == BATCH_CLOSE) ? 0 : e.position;
+        dirs[i] = m->directionTo(target);
+        if (dirs[i] == DIR_STOP) {
+            // Schon am Ziel: nicht starten, nur anhalten, falls er gerade darüber hinaus fährt
+            if (m->isMoving()) m->stop();
+            continue;
+        }
+        blockTime[dirs[i]] = max(blockTime[dirs[i]], m->estimateMoveTo(target));
+    }
+    
+    MotorDirection first = (blockTime[DIR_OPEN] <= blockTime[DIR_CLOSE]) ? DIR_OPEN : DIR_CLOSE;
+    MotorDirection second = (first == DIR_OPEN) ? DIR_CLOSE : DIR_OPEN;
+    MotorDirection order[2] = {first, second};
+    
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        for (uint8_t i = 0; i < batch.count; i++) {
+            const BatchEntry& e = batch.entries[i];
+            if (dirs[i] != order[pass]) continue;
+            MotorController* m = motors[e.motor - 1];
+            if (e.action == BATCH_OPEN) m->open();
+            else if (e.action == BATCH_CLOSE) m->close();
+            else m->moveToPosition(e.position);
+        }
+    }
+}
+
+// Befehl aus der CommandQueue ausführen (nur im Motor-Task)
+void applyCommand(const ControlCommand& command) {
+    MotorController* motors[4] = {motor1, motor2, motor3, motor4};
+    
+    if (command.type == CONTROL_BATCH) {
+        applyBatch(command.batch);
+    } else if (command.motor == 0) {
+        if (command.type == CONTROL_MOVE) {
+            for (uint8_t i = 0; i < 4; i++) handleMotorCommand(motors[i], command.arg);
+        } else {
+            handleLearnAll(command.arg);
+        }
+    } else if (command.motor <= 4) {
+        MotorController* m = motors[command.motor - 1];
+        if (command.type == CONTROL_MOVE) handleMotorCommand(m, command.arg);
+        else handleLearn(m, command.arg);
     }
 }
 
@@ -165,6 +249,127 @@ void handleRFClear(int key) {
     }
 }
 
+// ===== Scheduler-Tasks =====
+
+uint32_t otaTaskFn(uint32_t now) {
+    ArduinoOTA.handle();
+    return OTA_POLL_INTERVAL_MS;
+}
+
+uint32_t motorTaskFn(uint32_t now) {
+    // Befehle aus Web, MQTT und Tasten in Eingangsreihenfolge, alle in diesem Durchlauf
+    ControlCommand command;
+    while (CommandQueue::take(command)) {
+        applyCommand(command);
+    }
+    
+    // PWM Controller Update (Sanftanlauf, Relais)
+    PWMController::loop();
+    
+    // Motor Updates
+    motor1->loop();
+    motor2->loop();
+    motor3->loop();
+    motor4->loop();
+    
+    uint32_t wait = PWMController::msUntilNextUpdate();
+    wait = min(wait, motor1->msUntilNextUpdate());
+    wait = min(wait, motor2->msUntilNextUpdate());
+    wait = min(wait, motor3->msUntilNextUpdate());
+    wait = min(wait, motor4->msUntilNextUpdate());
+    return wait;
+}
+
+uint32_t buttonTaskFn(uint32_t now) {
+    buttons->loop();
+    return buttons->msUntilNextUpdate();
+}
+
+MotorStatus getMotorStatus(MotorController* motor) {
+    MotorStatus status;
+    status.state = motor->getStateName();
+    status.direction = motor->getDirectionName();
+    status.position = motor->getPosition();
+    status.target = motor->isMoving() ? motor->getTargetPosition() : motor->getPosition();
+    status.current = motor->getCurrent();
+    return status;
+}
+
+// Motor-Ereignisse ins MQTT-Ereignisprotokoll
+void handleMotorEvent(MotorController* motor, MotorEvent event) {
+    if (!mqtt) return;
+    
+    MqttEventType type;
+    switch (event) {
+        case MOTOR_EVENT_MOVE:
+            type = (motor->getDirection() == DIR_OPEN) ? MQTT_EVENT_OPEN : MQTT_EVENT_CLOSE;
+            break;
+        case MOTOR_EVENT_OVERCURRENT:
+            type = MQTT_EVENT_OVERCURRENT;
+            break;
+        default:
+            type = MQTT_EVENT_STOP;
+            break;
+    }
+    mqtt->logEvent(motor->getId(), type, motor->getPosition());
+}
+
+WebMotorState getWebMotorState(MotorController* motor) {
+    WebMotorState state;
+    state.position = motor->getPosition();
+    state.state = motor->getStateName();
+    state.calibrated = motor->getCalibrated();
+    state.calibrating = motor->isAutoCalibrating();
+    state.moving = motor->isMoving();
+    return state;
+}
+
+uint32_t publishMqttStatus() {
+    // Erst das Ereignisprotokoll (Geschichte), dann der aktuelle Stand
+    bool eventsSent = mqtt->flushEvents();
+    
+    // Status via MQTT publishen (nur Änderungen, sonst Heartbeat)
+    mqtt->updateMotorState(1, getMotorStatus(motor1), motor1->isMoving());
+    mqtt->updateMotorState(2, getMotorStatus(motor2), motor2->isMoving());
+    mqtt->updateMotorState(3, getMotorStatus(motor3), motor3->isMoving());
+    mqtt->updateMotorState(4, getMotorStatus(motor4), motor4->isMoving());
+    mqtt->updateSystemState(StatusSnapshot::getSystem());
+    
+    if (motor1->isMoving() || motor2->isMoving() || motor3->isMoving() || motor4->isMoving() || !eventsSent) {
+        return STATUS_MOVING_INTERVAL_MS;
+    }
+    return mqtt->msUntilHeartbeat();
+}
+
+uint32_t statusTaskFn(uint32_t now) {
+    // Snapshot für /status: nur bei Änderung neu serialisiert
+    MotorSnapshot snapshots[4] = {
+        getMotorSnapshot(motor1), getMotorSnapshot(motor2),
+        getMotorSnapshot(motor3), getMotorSnapshot(motor4)
+    };
+    StatusSnapshot::updateMotors(snapshots, 4);
+    if (StatusSnapshot::systemDue()) {
+        StatusSnapshot::updateSystem(getSystemStatus());
+    }
+    
+    uint32_t wait = UINT32_MAX;
+    if (motor1->isMoving() || motor2->isMoving() || motor3->isMoving() || motor4->isMoving()) {
+        wait = WEB_EVENT_INTERVAL_MS;
+    }
+    if (mqtt) {
+        wait = min(wait, publishMqttStatus());
+    }
+    if (webserver) {
+        // Status-Stream für das Webinterface (/events)
+        WebMotorState states[4] = {
+            getWebMotorState(motor1), getWebMotorState(motor2),
+            getWebMotorState(motor3), getWebMotorState(motor4)
+        };
+        wait = min(wait, webserver->updateEvents(states, 4));
+    }
+    return wait;
+}
+
 void setup() {
     Serial.begin(115200);
     delay(1000);
@@ -176,6 +381,15 @@ void setup() {
     Serial.println("╚═══════════════════════════════════════╝");
     Serial.println();
     
+    // Scheduler (Hauptloop ohne delay)
+    Scheduler::begin();
+    
+    // Einziger Befehlseingang für Web, MQTT und Tasten
+    CommandQueue::begin();
+    
+    // /status-Snapshot (ETag eindeutig pro Boot)
+    StatusSnapshot::begin();
+    
     // PWM Controller
     PWMController::begin();
     
@@ -191,42 +405,40 @@ void setup() {
     motor3->begin();
     motor4->begin();
     
+    // Strommessung (INA219) im eigenen Task auf Core 0
+    CurrentSampler::begin();
+    
     // Taster initialisieren
     Serial.println("\n=== Taster Initialisierung ===");
     buttons = new ButtonHandler();
     buttons->begin();
     
-    // Button Callbacks
-    buttons->onM1Open = []() { motor1->open(); };
-    buttons->onM1Close = []() { motor1->close(); };
-    buttons->onM1Stop = []() { motor1->stop(); };
+    // Button Callbacks (Tasten/RF werden im Hauptloop ausgewertet, gehen aber
+    // wie alle Eingänge über die CommandQueue)
+    buttons->onM1Open = []() { postCommand(CONTROL_MOVE, 1, "OPEN"); };
+    buttons->onM1Close = []() { postCommand(CONTROL_MOVE, 1, "CLOSE"); };
+    buttons->onM1Stop = []() { postCommand(CONTROL_MOVE, 1, "STOP"); };
     
-    buttons->onM2Open = []() { motor2->open(); };
-    buttons->onM2Close = []() { motor2->close(); };
-    buttons->onM2Stop = []() { motor2->stop(); };
+    buttons->onM2Open = []() { postCommand(CONTROL_MOVE, 2, "OPEN"); };
+    buttons->onM2Close = []() { postCommand(CONTROL_MOVE, 2, "CLOSE"); };
+    buttons->onM2Stop = []() { postCommand(CONTROL_MOVE, 2, "STOP"); };
     
-    buttons->onM3Open = []() { motor3->open(); };
-    buttons->onM3Close = []() { motor3->close(); };
-    buttons->onM3Stop = []() { motor3->stop(); };
+    buttons->onM3Open = []() { postCommand(CONTROL_MOVE, 3, "OPEN"); };
+    buttons->onM3Close = []() { postCommand(CONTROL_MOVE, 3, "CLOSE"); };
+    buttons->onM3Stop = []() { postCommand(CONTROL_MOVE, 3, "STOP"); };
     
-    buttons->onM4Open = []() { motor4->open(); };
-    buttons->onM4Close = []() { motor4->close(); };
-    buttons->onM4Stop = []() { motor4->stop(); };
+    buttons->onM4Open = []() { postCommand(CONTROL_MOVE, 4, "OPEN"); };
+    buttons->onM4Close = []() { postCommand(CONTROL_MOVE, 4, "CLOSE"); };
+    buttons->onM4Stop = []() { postCommand(CONTROL_MOVE, 4, "STOP"); };
     
     // Alle AUF/ZU Callbacks
     buttons->onAllOpen = []() {
         Serial.println("=== Alle Motoren ÖFFNEN ===");
-        motor1->open();
-        motor2->open();
-        motor3->open();
-        motor4->open();
+        postCommand(CONTROL_MOVE, 0, "OPEN");
     };
     buttons->onAllClose = []() {
         Serial.println("=== Alle Motoren SCHLIEßEN ===");
-        motor1->close();
-        motor2->close();
-        motor3->close();
-        motor4->close();
+        postCommand(CONTROL_MOVE, 0, "CLOSE");
     };
     
     // WiFi verbinden
@@ -244,39 +456,58 @@ void setup() {
         mqtt = new MQTTHandler();
         mqtt->begin();
         
-        // MQTT Callbacks
-        mqtt->onMotor1Command = [](const char* cmd) { handleMotorCommand(motor1, cmd); };
-        mqtt->onMotor2Command = [](const char* cmd) { handleMotorCommand(motor2, cmd); };
-        mqtt->onMotor3Command = [](const char* cmd) { handleMotorCommand(motor3, cmd); };
-        mqtt->onMotor4Command = [](const char* cmd) { handleMotorCommand(motor4, cmd); };
+        // MQTT Callbacks (laufen im MQTT-Task: nur einreihen)
+        mqtt->onMotor1Command = [](const char* cmd) { return postCommand(CONTROL_MOVE, 1, cmd); };
+        mqtt->onMotor2Command = [](const char* cmd) { return postCommand(CONTROL_MOVE, 2, cmd); };
+        mqtt->onMotor3Command = [](const char* cmd) { return postCommand(CONTROL_MOVE, 3, cmd); };
+        mqtt->onMotor4Command = [](const char* cmd) { return postCommand(CONTROL_MOVE, 4, cmd); };
+        mqtt->onAllCommand = [](const char* cmd) { return postCommand(CONTROL_MOVE, 0, cmd); };
         
-        mqtt->onAllCommand = [](const char* cmd) {
-            handleMotorCommand(motor1, cmd);
-            handleMotorCommand(motor2, cmd);
-            handleMotorCommand(motor3, cmd);
-            handleMotorCommand(motor4, cmd);
-        };
+        mqtt->onMotor1Learn = [](const char* type) { return postCommand(CONTROL_LEARN, 1, type); };
+        mqtt->onMotor2Learn = [](const char* type) { return postCommand(CONTROL_LEARN, 2, type); };
+        mqtt->onMotor3Learn = [](const char* type) { return postCommand(CONTROL_LEARN, 3, type); };
+        mqtt->onMotor4Learn = [](const char* type) { return postCommand(CONTROL_LEARN, 4, type); };
+        mqtt->onAllLearn = [](const char* type) { return postCommand(CONTROL_LEARN, 0, type); };
+        mqtt->onBatch = postBatch;
         
         // Webserver initialisieren
         Serial.println("\n=== Webserver Initialisierung ===");
         webserver = new WebServerHandler();
         
-        // Webserver Callbacks
-        webserver->onMotor1Command = [](const char* cmd) { handleMotorCommand(motor1, cmd); };
-        webserver->onMotor2Command = [](const char* cmd) { handleMotorCommand(motor2, cmd); };
-        webserver->onMotor3Command = [](const char* cmd) { handleMotorCommand(motor3, cmd); };
-        webserver->onMotor4Command = [](const char* cmd) { handleMotorCommand(motor4, cmd); };
+        // Webserver Callbacks (laufen im AsyncTCP-Task: nur einreihen)
+        webserver->onMotor1Command = [](const char* cmd) { return postCommand(CONTROL_MOVE, 1, cmd); };
+        webserver->onMotor2Command = [](const char* cmd) { return postCommand(CONTROL_MOVE, 2, cmd); };
+        webserver->onMotor3Command = [](const char* cmd) { return postCommand(CONTROL_MOVE, 3, cmd); };
+        webserver->onMotor4Command = [](const char* cmd) { return postCommand(CONTROL_MOVE, 4, cmd); };
+        webserver->onAllCommand = [](const char* cmd) { return postCommand(CONTROL_MOVE, 0, cmd); };
         
-        webserver->onMotor1Learn = [](const char* type) { handleLearn(motor1, type); };
-        webserver->onMotor2Learn = [](const char* type) { handleLearn(motor2, type); };
-        webserver->onMotor3Learn = [](const char* type) { handleLearn(motor3, type); };
-        webserver->onMotor4Learn = [](const char* type) { handleLearn(motor4, type); };
-        
-        webserver->getStatusJson = getStatusJson;
+        webserver->onMotor1Learn = [](const char* type) { return postCommand(CONTROL_LEARN, 1, type); };
+        webserver->onMotor2Learn = [](const char* type) { return postCommand(CONTROL_LEARN, 2, type); };
+        webserver->onMotor3Learn = [](const char* type) { return postCommand(CONTROL_LEARN, 3, type); };
+        webserver->onMotor4Learn = [](const char* type) { return postCommand(CONTROL_LEARN, 4, type); };
+        webserver->onAllLearn = [](const char* type) { return postCommand(CONTROL_LEARN, 0, type); };
+        webserver->onBatch = postBatch;
         
         webserver->begin();
     }
     
+    // Scheduler-Tasks registrieren
+    Scheduler::add("ota", otaTaskFn);
+    motorTask = Scheduler::add("motoren", motorTaskFn);
+    CommandQueue::consumerTask = motorTask;
+    buttonTask = Scheduler::add("tasten", buttonTaskFn);
+    if (mqtt) {
+        MotorController::setEventHandler(handleMotorEvent);
+    }
+    if (mqtt || webserver) {
+        int8_t statusTask = Scheduler::add("status", statusTaskFn);
+        if (mqtt) mqtt->statusTask = statusTask;
+        if (webserver) webserver->statusTask = statusTask;
+        MotorController::setStatusTask(statusTask);
+    }
+    MotorController::setSchedulerTask(motorTask);
+    buttons->schedulerTask = buttonTask;
+    
     Serial.println("\n╔═══════════════════════════════════════╗");
     Serial.println("║         SYSTEM BEREIT!                ║");
     Serial.println("╚═══════════════════════════════════════╝");
@@ -287,38 +518,6 @@ void setup() {
 }
 
 void loop() {
-    // OTA Handle
-    ArduinoOTA.handle();
-    
-    // PWM Controller Update (Sanftanlauf)
-    PWMController::loop();
-    
-    // Motor Updates
-    motor1->loop();
-    motor2->loop();
-    motor3->loop();
-    motor4->loop();
-    
-    // Button Updates
-    buttons->loop();
-    
-    // MQTT Update
-    if (mqtt) {
-        mqtt->loop();
-    }
-    
-    // Status via MQTT publishen (alle 2 Sekunden)
-    unsigned long now = millis();
-    if (now - lastStatusUpdate > 2000) {
-        lastStatusUpdate = now;
-        
-        if (mqtt) {
-            mqtt->publishMotorState(1, "running", motor1->getPosition(), 0);
-            mqtt->publishMotorState(2, "running", motor2->getPosition(), 0);
-            mqtt->publishMotorState(3, "running", motor3->getPosition(), 0);
-            mqtt->publishMotorState(4, "running", motor4->getPosition(), 0);
-        }
-    }
-    
-    delay(10);
+    // Fällige Tasks ausführen, dann bis zur nächsten Deadline oder zum nächsten Ereignis schlafen
+    Scheduler::run();
 }
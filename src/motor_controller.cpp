@@ -1,24 +1,69 @@
 #include "motor_controller.h"
 #include "config.h"
+#include "scheduler.h"
+#include "current_sampler.h"
 
-uint8_t PWMController::activeMotorsOpen = 0;
-uint8_t PWMController::activeMotorsClose = 0;
-uint8_t PWMController::currentPWM = 0;
-bool PWMController::softStartActive = false;
-unsigned long PWMController::softStartBegin = 0;
-unsigned long PWMController::lastPWMUpdate = 0;
+PWMOutput PWMController::outputs[PWM_OUTPUT_COUNT];
+uint8_t PWMController::rampTables[RAMP_CURVE_COUNT - 1][RAMP_TABLE_SIZE + 1];
+uint8_t PWMController::learnedTables[PWM_OUTPUT_COUNT][RAMP_TABLE_SIZE + 1];
+esp_timer_handle_t PWMController::rampTimer = nullptr;
+bool PWMController::rampTimerRunning = false;
+portMUX_TYPE PWMController::rampMux = portMUX_INITIALIZER_UNLOCKED;
+unsigned long PWMController::lastRampStep = 0;
 bool PWMController::relayOn = false;
+bool PWMController::relayReady = false;
+unsigned long PWMController::relayOnTime = 0;
+unsigned long PWMController::relayReadyTime = 0;
 unsigned long PWMController::lastMotorStopTime = 0;
 bool PWMController::relayShutdownPending = false;
 
 void PWMController::begin() {
-    ledcSetup(RPWM_CHANNEL, PWM_FREQ, PWM_RESOLUTION);
-    ledcSetup(LPWM_CHANNEL, PWM_FREQ, PWM_RESOLUTION);
-    ledcAttachPin(RPWM_ALL, RPWM_CHANNEL);
-    ledcAttachPin(LPWM_ALL, LPWM_CHANNEL);
+    buildRampTables();
     
-    ledcWrite(RPWM_CHANNEL, 0);
-    ledcWrite(LPWM_CHANNEL, 0);
+    // Kanalpaare: Ausgang n nutzt RPWM_CHANNEL + 2n / LPWM_CHANNEL + 2n
+    for (uint8_t i = 0; i < PWM_OUTPUT_COUNT; i++) {
+        PWMOutput& out = outputs[i];
+        out.rChannel = RPWM_CHANNEL + 2 * i;
+        out.lChannel = LPWM_CHANNEL + 2 * i;
+        out.activeOpen = 0;
+        out.activeClose = 0;
+        out.pwm = 0;
+        out.curve = SOFT_START_CURVE;
+        out.rampFrom = 0;
+        out.rampTo = 0;
+        out.rampBeginUs = 0;
+        out.rampDurationUs = 0;
+        out.softStartActive = false;
+        out.softStopActive = false;
+        out.softStopDone = false;
+        out.skipSoftStart = false;
+        out.cut = false;
+        out.appliedDuty = 0;
+        out.appliedSinceUs = esp_timer_get_time();
+        out.travelQ16 = 0;
+        
+        ledcSetup(out.rChannel, PWM_FREQ, PWM_RESOLUTION);
+        ledcSetup(out.lChannel, PWM_FREQ, PWM_RESOLUTION);
+        ledcWrite(out.rChannel, 0);
+        ledcWrite(out.lChannel, 0);
+    }
+    
+    loadLearnedCurves();
+    
+    #if !PWM_PER_MOTOR
+    attachOutput(0, RPWM_ALL, LPWM_ALL);
+    #endif
+    
+    // Rampen laufen im esp_timer-Task, unabhängig vom Takt des Hauptloops
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = onRampTimer;
+    timerArgs.arg = nullptr;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "pwm_ramp";
+    if (esp_timer_create(&timerArgs, &rampTimer) != ESP_OK) {
+        rampTimer = nullptr;
+        Serial.println("PWM-Controller: Kein Rampen-Timer - Rampenschritte aus dem Hauptloop");
+    }
     
     // Relais-Pin initialisieren (invertiert: HIGH = AUS bei RELAY_ACTIVE_LOW)
     pinMode(MOTOR_POWER_RELAY_PIN, OUTPUT);
@@ -28,56 +73,383 @@ void PWMController::begin() {
     digitalWrite(MOTOR_POWER_RELAY_PIN, LOW);   // Normal: LOW = AUS
     #endif
     relayOn = false;
+    relayReady = false;
     
+    #if PWM_PER_MOTOR
+    Serial.println("PWM-Controller: Initialisiert (PWM pro Motor mit eigenem Sanftanlauf + Relais)");
+    #else
     Serial.println("PWM-Controller: Initialisiert (gemeinsame PWM mit Sanftanlauf + Relais)");
+    #endif
+}
+
+// Rampenformen einmalig berechnen: Fortschritt 0..255 über RAMP_TABLE_SIZE Abschnitte
+void PWMController::buildRampTables() {
+    const float expNorm = 1.0f - expf(-RAMP_EXP_FACTOR);
+    
+    for (uint8_t c = 0; c < RAMP_CURVE_COUNT - 1; c++) {
+        for (uint16_t i = 0; i <= RAMP_TABLE_SIZE; i++) {
+            float x = (float)i / RAMP_TABLE_SIZE;
+            float y;
+            switch (c) {
+                case RAMP_SCURVE:
+                    y = x * x * (3.0f - 2.0f * x);
+                    break;
+                case RAMP_EXPONENTIAL:
+                    y = (1.0f - expf(-RAMP_EXP_FACTOR * x)) / expNorm;
+                    break;
+                case RAMP_LINEAR:
+                default:
+                    y = x;
+                    break;
+            }
+            rampTables[c][i] = (uint8_t)constrain((int)lroundf(y * 255.0f), 0, 255);
+        }
+    }
+}
+
+void PWMController::loadLearnedCurves() {
+    Preferences prefs;
+    prefs.begin(PREFS_NAMESPACE, true);
+    
+    for (uint8_t i = 0; i < PWM_OUTPUT_COUNT; i++) {
+        String key = "ramp" + String(i);
+        if (prefs.getBytesLength(key.c_str()) == RAMP_TABLE_SIZE + 1) {
+            prefs.getBytes(key.c_str(), learnedTables[i], RAMP_TABLE_SIZE + 1);
+        } else {
+            memcpy(learnedTables[i], rampTables[RAMP_SCURVE], RAMP_TABLE_SIZE + 1);
+        }
+    }
+    
+    prefs.end();
+}
+
+const uint8_t* PWMController::getRampTable(uint8_t output) {
+    RampCurve curve = outputs[output].curve;
+    if (curve == RAMP_LEARNED) return learnedTables[output];
+    return rampTables[curve < RAMP_LEARNED ? curve : RAMP_LINEAR];
+}
+
+void PWMController::setRampCurve(uint8_t output, RampCurve curve) {
+    if (output >= PWM_OUTPUT_COUNT || curve >= RAMP_CURVE_COUNT) return;
+    outputs[output].curve = curve;
+}
+
+void PWMController::setLearnedCurve(uint8_t output, const uint8_t* table) {
+    if (output >= PWM_OUTPUT_COUNT) return;
+    
+    portENTER_CRITICAL(&rampMux);
+    memcpy(learnedTables[output], table, RAMP_TABLE_SIZE + 1);
+    portEXIT_CRITICAL(&rampMux);
+    
+    Preferences prefs;
+    prefs.begin(PREFS_NAMESPACE, false);
+    prefs.putBytes(("ramp" + String(output)).c_str(), table, RAMP_TABLE_SIZE + 1);
+    prefs.end();
+    
+    Serial.printf("PWM-Controller: Gelernte Rampe für Ausgang %d gespeichert\n", output);
+}
+
+void PWMController::attachOutput(uint8_t output, uint8_t rPin, uint8_t lPin) {
+    if (output >= PWM_OUTPUT_COUNT) return;
+    ledcAttachPin(rPin, outputs[output].rChannel);
+    ledcAttachPin(lPin, outputs[output].lChannel);
+}
+
+uint8_t PWMController::outputForMotor(uint8_t motorId) {
+    #if PWM_PER_MOTOR
+    return constrain(motorId, 1, PWM_OUTPUT_COUNT) - 1;
+    #else
+    (void)motorId;
+    return 0;
+    #endif
 }
 
 void PWMController::loop() {
+    // Ohne esp_timer: Rampenschritte im Takt des Hauptloops
+    if (!rampTimer && millis() - lastRampStep >= SOFT_START_STEP_INTERVAL) {
+        lastRampStep = millis();
+        stepRamps();
+    }
+    
+    updateRelayControl();
+}
+
+uint32_t PWMController::msUntilNextUpdate() {
     unsigned long now = millis();
+    uint32_t wait = UINT32_MAX;
+    
+    if (!rampTimer) {
+        for (uint8_t i = 0; i < PWM_OUTPUT_COUNT; i++) {
+            const PWMOutput& out = outputs[i];
+            if (out.softStartActive || out.softStopActive) {
+                unsigned long elapsed = now - lastRampStep;
+                uint32_t stepWait = elapsed >= SOFT_START_STEP_INTERVAL ? 0 : SOFT_START_STEP_INTERVAL - elapsed;
+                wait = min(wait, stepWait);
+            }
+        }
+    }
     
-    if (softStartActive && now - lastPWMUpdate >= SOFT_START_STEP_INTERVAL) {
-        updateSoftStart();
-        lastPWMUpdate = now;
+    if (relayOn && !relayReady) {
+        unsigned long elapsed = now - relayOnTime;
+        uint32_t readyWait = elapsed >= RELAY_PRE_ON_DELAY_MS ? 0 : RELAY_PRE_ON_DELAY_MS - elapsed;
+        wait = min(wait, readyWait);
     }
     
-    updateRelayControl();
+    if (relayShutdownPending && relayOn) {
+        unsigned long elapsed = now - lastMotorStopTime;
+        uint32_t relayWait = elapsed >= RELAY_POST_OFF_DELAY_MS ? 0 : RELAY_POST_OFF_DELAY_MS - elapsed;
+        wait = min(wait, relayWait);
+    }
+    
+    return wait;
 }
 
-void PWMController::updateSoftStart() {
-    if (!softStartActive) return;
+// ===== Rampen-Engine =====
+
+// Tastgrad zum Zeitpunkt nowUs: Tabellenwert mit 8 Bit Zwischenschritten interpolieren
+uint8_t PWMController::rampDuty(uint8_t output, int64_t nowUs, bool* finished) {
+    const PWMOutput& out = outputs[output];
+    int64_t elapsed = nowUs - out.rampBeginUs;
     
-    unsigned long elapsed = millis() - softStartBegin;
+    if (elapsed >= (int64_t)out.rampDurationUs || out.rampDurationUs == 0) {
+        *finished = true;
+        return out.rampTo;
+    }
+    *finished = false;
+    if (elapsed < 0) elapsed = 0;
+    
+    const uint8_t* table = getRampTable(output);
+    uint32_t pos = (uint32_t)(((uint64_t)elapsed * RAMP_TABLE_SIZE * 256) / out.rampDurationUs);
+    uint16_t index = pos >> 8;
+    uint16_t frac = pos & 0xFF;
+    int32_t shape = table[index] + (((int32_t)table[index + 1] - table[index]) * frac >> 8);
     
-    if (elapsed >= SOFT_START_DURATION_MS) {
-        softStartActive = false;
-        currentPWM = SOFT_START_MAX_PWM;
-        Serial.printf("PWM-Controller: Sanftanlauf beendet (PWM=%d)\n", currentPWM);
+    return out.rampFrom + ((int32_t)out.rampTo - out.rampFrom) * shape / 255;
+}
+
+void PWMController::startRamp(uint8_t output, uint8_t from, uint8_t to, uint32_t durationMs) {
+    PWMOutput& out = outputs[output];
+    out.rampFrom = from;
+    out.rampTo = to;
+    out.rampBeginUs = esp_timer_get_time();
+    out.rampDurationUs = durationMs * 1000UL;
+    out.pwm = from;
+}
+
+void PWMController::stepRamps() {
+    int64_t nowUs = esp_timer_get_time();
+    bool wake = false;
+    
+    for (uint8_t i = 0; i < PWM_OUTPUT_COUNT; i++) {
+        PWMOutput& out = outputs[i];
+        bool write = false;
+        
+        portENTER_CRITICAL(&rampMux);
+        if (relayReady && (out.softStartActive || out.softStopActive)) {
+            bool finished;
+            out.pwm = rampDuty(i, nowUs, &finished);
+            if (finished && out.softStopActive) {
+                // Sanftstopp angekommen: Ausgang bleibt aus, Motor-Loop übernimmt
+                out.softStopActive = false;
+                out.softStopDone = true;
+                out.cut = true;
+                wake = true;
+            } else if (finished) {
+                out.softStartActive = false;
+                wake = true;
+            }
+            write = true;
+        }
+        portEXIT_CRITICAL(&rampMux);
+        
+        if (write) writeOutput(i);
+    }
+    
+    if (wake) Scheduler::wake(MotorController::getSchedulerTask());
+}
+
+// Läuft im esp_timer-Task
+void PWMController::onRampTimer(void* arg) {
+    (void)arg;
+    stepRamps();
+}
+
+// Timer läuft, solange Motoren aktiv sind - Start und Stopp nur aus dem Hauptloop
+void PWMController::startRampTimer() {
+    if (!rampTimer || rampTimerRunning) return;
+    if (esp_timer_start_periodic(rampTimer, RAMP_STEP_MS * 1000ULL) == ESP_OK) {
+        rampTimerRunning = true;
+    }
+}
+
+void PWMController::stopRampTimer() {
+    if (!rampTimer || !rampTimerRunning) return;
+    esp_timer_stop(rampTimer);
+    rampTimerRunning = false;
+}
+
+void PWMController::startSoftStart(uint8_t output) {
+    PWMOutput& out = outputs[output];
+    bool ramp = SOFT_START_ENABLED && !out.skipSoftStart;
+    
+    portENTER_CRITICAL(&rampMux);
+    out.softStopActive = false;
+    out.softStopDone = false;
+    if (ramp) {
+        startRamp(output, SOFT_START_MIN_PWM, SOFT_START_MAX_PWM, SOFT_START_DURATION_MS);
+        out.softStartActive = true;
     } else {
-        float progress = (float)elapsed / SOFT_START_DURATION_MS;
-        currentPWM = SOFT_START_MIN_PWM + (progress * (SOFT_START_MAX_PWM - SOFT_START_MIN_PWM));
+        out.softStartActive = false;
+        out.pwm = SOFT_START_MAX_PWM;
+    }
+    out.skipSoftStart = false;
+    portEXIT_CRITICAL(&rampMux);
+    
+    if (ramp) {
+        Serial.printf("PWM-Controller: Sanftanlauf Ausgang %d gestartet (%d->%d über %dms)\n", 
+                     output, SOFT_START_MIN_PWM, SOFT_START_MAX_PWM, SOFT_START_DURATION_MS);
+    }
+}
+
+bool PWMController::startSoftStop(uint8_t output) {
+    if (!SOFT_STOP_ENABLED || output >= PWM_OUTPUT_COUNT) return false;
+    PWMOutput& out = outputs[output];
+    bool started = false;
+    
+    portENTER_CRITICAL(&rampMux);
+    if (relayReady && !out.cut && !out.softStopActive && out.pwm > 0 &&
+        out.activeOpen + out.activeClose == 1) {
+        // Dauer anteilig zur aktuellen PWM (gleiche Steilheit wie ab voller PWM)
+        uint32_t durationMs = (uint32_t)SOFT_STOP_DURATION_MS * out.pwm / SOFT_START_MAX_PWM;
+        out.softStartActive = false;
+        startRamp(output, out.pwm, 0, max(durationMs, (uint32_t)RAMP_STEP_MS));
+        out.softStopActive = true;
+        out.softStopDone = false;
+        started = true;
+    }
+    portEXIT_CRITICAL(&rampMux);
+    
+    return started;
+}
+
+uint32_t PWMController::getSoftStopTravelMs(uint8_t output, uint8_t fromPwm) {
+    if (!SOFT_STOP_ENABLED || fromPwm == 0) return 0;
+    
+    // Rampe fromPwm -> 0 mit derselben Steilheit wie in startSoftStop(): mittlere
+    // Geschwindigkeit über die Stützstellen (unter der Haftreibung steht der Motor)
+    const uint8_t* table = getRampTable(output);
+    uint64_t sum = 0;
+    for (uint16_t i = 0; i <= RAMP_TABLE_SIZE; i++) {
+        uint32_t speed = dutySpeed(fromPwm - fromPwm * table[i] / 255);
+        sum += (i == 0 || i == RAMP_TABLE_SIZE) ? speed : 2 * speed;
+    }
+    uint32_t durationMs = (uint32_t)SOFT_STOP_DURATION_MS * fromPwm / SOFT_START_MAX_PWM;
+    return (uint32_t)((sum * durationMs / (2 * RAMP_TABLE_SIZE)) >> 16);
+}
+
+// ===== Fahrweg-Integral =====
+
+uint32_t PWMController::dutySpeed(uint8_t pwm) {
+    if (pwm <= KINEMATIC_DEADBAND_PWM) return 0;
+    return ((uint32_t)(pwm - KINEMATIC_DEADBAND_PWM) << 16) / (SOFT_START_MAX_PWM - KINEMATIC_DEADBAND_PWM);
+}
+
+uint64_t PWMController::getTravelUs(uint8_t output) {
+    const PWMOutput& out = outputs[output];
+    int64_t nowUs = esp_timer_get_time();
+    
+    portENTER_CRITICAL(&rampMux);
+    uint64_t travel = out.travelQ16 + (uint64_t)dutySpeed(out.appliedDuty) * (uint64_t)(nowUs - out.appliedSinceUs);
+    portEXIT_CRITICAL(&rampMux);
+    
+    return travel >> 16;
+}
+
+// Laufende Rampe in RAMP_STEP_MS-Schritten vorausrechnen, danach mit ihrem Endwert
+uint64_t PWMController::predictTimeUs(uint8_t output, uint64_t travelUs) {
+    const PWMOutput& out = outputs[output];
+    int64_t nowUs = esp_timer_get_time();
+    uint64_t needed = travelUs << 16;
+    int64_t t = nowUs;
+    uint8_t finalPwm = out.pwm;
+    
+    if (out.softStartActive) {
+        const int64_t stepUs = RAMP_STEP_MS * 1000LL;
+        int64_t rampEnd = out.rampBeginUs + out.rampDurationUs;
+        bool finished = false;
+        while (t < rampEnd && !finished) {
+            uint32_t speed = dutySpeed(rampDuty(output, t + stepUs / 2, &finished));
+            uint64_t step = (uint64_t)speed * stepUs;
+            if (step >= needed) {
+                return (t - nowUs) + (speed > 0 ? needed / speed : 0);
+            }
+            needed -= step;
+            t += stepUs;
+        }
+        finalPwm = out.rampTo;
     }
     
-    if (activeMotorsOpen > 0 && activeMotorsClose == 0) {
-        ledcWrite(RPWM_CHANNEL, currentPWM);
-        ledcWrite(LPWM_CHANNEL, 0);
-    } else if (activeMotorsClose > 0 && activeMotorsOpen == 0) {
-        ledcWrite(RPWM_CHANNEL, 0);
-        ledcWrite(LPWM_CHANNEL, currentPWM);
-    } else if (activeMotorsOpen > 0 && activeMotorsClose > 0) {
+    uint32_t speed = dutySpeed(finalPwm);
+    if (speed == 0) return 0;
+    return (t - nowUs) + needed / speed;
+}
+
+// Einzige Stelle, die LEDC-Kanäle beschreibt: Fahrweg-Integral bis jetzt fortschreiben
+void PWMController::writeDuty(uint8_t output, uint8_t rDuty, uint8_t lDuty) {
+    PWMOutput& out = outputs[output];
+    int64_t nowUs = esp_timer_get_time();
+    
+    portENTER_CRITICAL(&rampMux);
+    out.travelQ16 += (uint64_t)dutySpeed(out.appliedDuty) * (uint64_t)(nowUs - out.appliedSinceUs);
+    out.appliedDuty = max(rDuty, lDuty);
+    out.appliedSinceUs = nowUs;
+    portEXIT_CRITICAL(&rampMux);
+    
+    ledcWrite(out.rChannel, rDuty);
+    ledcWrite(out.lChannel, lDuty);
+}
+
+void PWMController::writeOutput(uint8_t output) {
+    PWMOutput& out = outputs[output];
+    
+    // Ohne Motorspannung bleibt PWM aus - Befehle sind vorgemerkt.
+    // Nach Stopp-Timer oder Sanftstopp bleibt der Ausgang bis motorStopped() aus.
+    if (!relayReady || out.cut) {
+        writeDuty(output, 0, 0);
+        return;
+    }
+    
+    if (out.activeOpen > 0 && out.activeClose == 0) {
+        writeDuty(output, out.pwm, 0);
+    } else if (out.activeClose > 0 && out.activeOpen == 0) {
+        writeDuty(output, 0, out.pwm);
+    } else if (out.activeOpen > 0 && out.activeClose > 0) {
         Serial.println("PWM-Controller: KONFLIKT! Verschiedene Richtungen!");
-        ledcWrite(RPWM_CHANNEL, 0);
-        ledcWrite(LPWM_CHANNEL, 0);
-        currentPWM = 0;
+        writeDuty(output, 0, 0);
+        out.pwm = 0;
     } else {
-        ledcWrite(RPWM_CHANNEL, 0);
-        ledcWrite(LPWM_CHANNEL, 0);
-        currentPWM = 0;
+        writeDuty(output, 0, 0);
+        out.pwm = 0;
     }
 }
 
 void PWMController::updateRelayControl() {
     unsigned long now = millis();
     
+    // Einschaltverzögerung abgelaufen: vorgemerkte Motoren bekommen PWM
+    if (relayOn && !relayReady && now - relayOnTime >= RELAY_PRE_ON_DELAY_MS) {
+        relayReady = true;
+        relayReadyTime = now;
+        Serial.printf("Relais: bereit nach %dms\n", RELAY_PRE_ON_DELAY_MS);
+        
+        for (uint8_t i = 0; i < PWM_OUTPUT_COUNT; i++) {
+            if (outputs[i].activeOpen + outputs[i].activeClose > 0) {
+                startSoftStart(i);
+                writeOutput(i);
+            }
+        }
+    }
+    
     // Prüfen, ob Relais ausgeschaltet werden soll
     if (relayShutdownPending && relayOn) {
         if (now - lastMotorStopTime >= RELAY_POST_OFF_DELAY_MS) {
@@ -87,110 +459,212 @@ void PWMController::updateRelayControl() {
             digitalWrite(MOTOR_POWER_RELAY_PIN, LOW);   // Normal: LOW = AUS
             #endif
             relayOn = false;
+            relayReady = false;
             relayShutdownPending = false;
             Serial.printf("Relais: AUS (%lums nach letztem Motor)\n", RELAY_POST_OFF_DELAY_MS);
         }
     }
 }
 
-void PWMController::motorStarted(MotorDirection dir) {
+void PWMController::motorStarted(uint8_t output, MotorDirection dir) {
+    PWMOutput& out = outputs[output];
+    
+    portENTER_CRITICAL(&rampMux);
     if (dir == DIR_OPEN) {
-        activeMotorsOpen++;
+        out.activeOpen++;
     } else if (dir == DIR_CLOSE) {
-        activeMotorsClose++;
+        out.activeClose++;
+    }
+    out.cut = false;
+    // Sanftstopp eines anderen Motors am gemeinsamen Ausgang abbrechen: die Rampe liefe
+    // sonst für den neuen Motor auf 0 (MotorController hält den stoppenden Motor vorher an)
+    if (out.softStopActive || out.softStopDone) {
+        out.softStopActive = false;
+        out.softStopDone = false;
+        out.pwm = SOFT_START_MAX_PWM;
     }
+    portEXIT_CRITICAL(&rampMux);
     
-    // Relais einschalten, wenn erster Motor startet
-    if (getActiveMotorCount() == 1) {
-        if (!relayOn) {
-            #if RELAY_ACTIVE_LOW
-            digitalWrite(MOTOR_POWER_RELAY_PIN, LOW);   // Invertiert: LOW = EIN
-            #else
-            digitalWrite(MOTOR_POWER_RELAY_PIN, HIGH);  // Normal: HIGH = EIN
-            #endif
-            relayOn = true;
-            relayShutdownPending = false;
-            Serial.printf("Relais: EIN (wartet %dms vor Motorstart)\n", RELAY_PRE_ON_DELAY_MS);
-            
-            // Warten auf Relais-Einschaltverzögerung
-            delay(RELAY_PRE_ON_DELAY_MS);
-        }
-        
-        if (SOFT_START_ENABLED) {
-            softStartActive = true;
-            softStartBegin = millis();
-            lastPWMUpdate = softStartBegin;
-            currentPWM = SOFT_START_MIN_PWM;
-            Serial.printf("PWM-Controller: Sanftanlauf gestartet (%d->%d über %dms)\n", 
-                         SOFT_START_MIN_PWM, SOFT_START_MAX_PWM, SOFT_START_DURATION_MS);
-        } else {
-            currentPWM = SOFT_START_MAX_PWM;
-        }
-    } else if (!softStartActive) {
-        currentPWM = SOFT_START_MAX_PWM;
+    startRampTimer();
+    
+    // Laufender Motor: geplante Relais-Abschaltung verwerfen
+    relayShutdownPending = false;
+    
+    // Relais einschalten, wenn erster Motor startet - nicht blockierend:
+    // Der Befehl bleibt vorgemerkt, bis updateRelayControl() die Bereitschaft meldet
+    if (!relayOn) {
+        #if RELAY_ACTIVE_LOW
+        digitalWrite(MOTOR_POWER_RELAY_PIN, LOW);   // Invertiert: LOW = EIN
+        #else
+        digitalWrite(MOTOR_POWER_RELAY_PIN, HIGH);  // Normal: HIGH = EIN
+        #endif
+        relayOn = true;
+        relayReady = false;
+        relayOnTime = millis();
+        Serial.printf("Relais: EIN (Motorstart in %dms)\n", RELAY_PRE_ON_DELAY_MS);
+    }
+    
+    if (!relayReady) {
+        writeOutput(output);
+        return;
+    }
+    
+    // Gemeinsame PWM: weitere Motoren übernehmen die laufende Rampe
+    if (out.activeOpen + out.activeClose == 1) {
+        startSoftStart(output);
+    } else if (!out.softStartActive) {
+        out.pwm = SOFT_START_MAX_PWM;
     }
     
-    updateSoftStart();
+    writeOutput(output);
 }
 
-void PWMController::motorStopped(MotorDirection dir) {
-    if (dir == DIR_OPEN && activeMotorsOpen > 0) {
-        activeMotorsOpen--;
-    } else if (dir == DIR_CLOSE && activeMotorsClose > 0) {
-        activeMotorsClose--;
+void PWMController::motorStopped(uint8_t output, MotorDirection dir) {
+    PWMOutput& out = outputs[output];
+    bool idle;
+    
+    portENTER_CRITICAL(&rampMux);
+    if (dir == DIR_OPEN && out.activeOpen > 0) {
+        out.activeOpen--;
+    } else if (dir == DIR_CLOSE && out.activeClose > 0) {
+        out.activeClose--;
+    }
+    idle = (out.activeOpen + out.activeClose == 0);
+    if (idle) {
+        out.pwm = 0;
+        out.softStartActive = false;
+        out.softStopActive = false;
+        out.softStopDone = false;
+        out.cut = false;
+    }
+    portEXIT_CRITICAL(&rampMux);
+    
+    if (idle) {
+        writeDuty(output, 0, 0);
+    } else {
+        writeOutput(output);
     }
     
+    // Relais-Abschaltungs-Timer starten
     if (getActiveMotorCount() == 0) {
-        ledcWrite(RPWM_CHANNEL, 0);
-        ledcWrite(LPWM_CHANNEL, 0);
-        currentPWM = 0;
-        softStartActive = false;
-        
-        // Relais-Abschaltungs-Timer starten
+        stopRampTimer();
         if (relayOn) {
             lastMotorStopTime = millis();
             relayShutdownPending = true;
             Serial.printf("Relais: Abschaltung in %lums geplant\n", RELAY_POST_OFF_DELAY_MS);
         }
-    } else {
-        updateSoftStart();
     }
 }
 
-void PWMController::setPWM(MotorDirection dir, uint8_t pwm) {
-    currentPWM = pwm;
+void PWMController::setPWM(uint8_t output, MotorDirection dir, uint8_t pwm) {
+    PWMOutput& out = outputs[output];
+    
+    portENTER_CRITICAL(&rampMux);
+    out.softStartActive = false;
+    out.softStopActive = false;
+    out.pwm = pwm;
+    portEXIT_CRITICAL(&rampMux);
     
     if (dir == DIR_OPEN) {
-        ledcWrite(RPWM_CHANNEL, pwm);
-        ledcWrite(LPWM_CHANNEL, 0);
+        writeDuty(output, pwm, 0);
     } else if (dir == DIR_CLOSE) {
-        ledcWrite(RPWM_CHANNEL, 0);
-        ledcWrite(LPWM_CHANNEL, pwm);
+        writeDuty(output, 0, pwm);
     } else {
-        ledcWrite(RPWM_CHANNEL, 0);
-        ledcWrite(LPWM_CHANNEL, 0);
+        writeDuty(output, 0, 0);
     }
 }
 
-void PWMController::resetSoftStart() {
-    softStartActive = false;
-    currentPWM = SOFT_START_MAX_PWM;
+// Läuft im esp_timer-Task (Stopp-Timer): nur Tastgrad auf 0, Buchhaltung folgt in motorStopped()
+void PWMController::cutOutput(uint8_t output) {
+    PWMOutput& out = outputs[output];
+    
+    portENTER_CRITICAL(&rampMux);
+    out.cut = true;
+    out.softStartActive = false;
+    out.softStopActive = false;
+    portEXIT_CRITICAL(&rampMux);
+    
+    writeDuty(output, 0, 0);
+}
+
+void PWMController::resetSoftStart(uint8_t output) {
+    PWMOutput& out = outputs[output];
+    
+    if (!relayReady) {
+        // Rampe beginnt erst mit Relais-Bereitschaft - dann direkt volle PWM
+        out.skipSoftStart = true;
+        return;
+    }
+    
+    portENTER_CRITICAL(&rampMux);
+    out.softStartActive = false;
+    out.pwm = SOFT_START_MAX_PWM;
+    portEXIT_CRITICAL(&rampMux);
+    
+    writeOutput(output);
+}
+
+uint8_t PWMController::getActiveMotorCount() {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < PWM_OUTPUT_COUNT; i++) {
+        count += outputs[i].activeOpen + outputs[i].activeClose;
+    }
+    return count;
+}
+
+bool PWMController::hasConflict(uint8_t output, MotorDirection dir) {
+    const PWMOutput& out = outputs[output];
+    if (dir == DIR_OPEN) return out.activeClose > 0;
+    if (dir == DIR_CLOSE) return out.activeOpen > 0;
+    return false;
 }
 
 // ===== MotorController =====
 
+int8_t MotorController::schedulerTask = -1;
+int8_t MotorController::statusTask = -1;
+void (*MotorController::eventHandler)(MotorController* motor, MotorEvent event) = nullptr;
+MotorController* MotorController::registry[MOTOR_REGISTRY_SIZE];
+uint8_t MotorController::registryCount = 0;
+
 MotorController::MotorController(uint8_t motorId, uint8_t ren, uint8_t len, uint8_t inaAddr) {
     id = motorId;
     pinREN = ren;
     pinLEN = len;
     inaAddress = inaAddr;
+    pwmOutput = PWMController::outputForMotor(motorId);
+    
+    currentChannel = -1;
+    endStopDetected = false;
+    endStopOverrunStart = 0;
     
-    ina219 = new Adafruit_INA219(inaAddress);
+    calPhase = CAL_IDLE;
+    calRuns = 0;
+    calRunsDone = 0;
+    calOpenSum = calCloseSum = 0;
+    calOpenMin = calOpenMax = calCloseMin = calCloseMax = 0;
+    calStepDone = false;
     
     state = STOPPED;
     currentDirection = DIR_STOP;
-    currentPosition = 0;
-    targetPosition = 0;
+    positionFine = 0;
+    targetFine = 0;
+    positionRemainder = 0;
+    
+    lastTravelUs = 0;
+    travelFine = 0;
+    positionAtEndStop = false;
+    travelFromEndStop = false;
+    inertiaProbeDir = DIR_STOP;
+    inertiaProbeFine = 0;
+    inertiaProbeScale = 1UL << 16;
+    loadRef_mA[0] = loadRef_mA[1] = 0.0;
+    load_mA[0] = load_mA[1] = 0.0;
+    loadSum = 0.0;
+    loadCount = 0;
+    loadMeasured = false;
+    fullPwmSince = 0;
+    loadScale = 1UL << 16;
     
     openTime = 0;
     closeTime = 0;
@@ -200,20 +674,43 @@ MotorController::MotorController(uint8_t motorId, uint8_t ren, uint8_t len, uint
     lastCurrentCheck = 0;
     overcurrentStartTime = 0;
     
+    stopTimer = nullptr;
+    stopTimerArmed = false;
+    stopTimerFired = false;
+    stopTimerHardPhase = false;
+    stopInertiaMs = STOP_INERTIA_MS;
+    stopTimerScale = 1UL << 16;
+    stopTimerRampPlanned = false;
+    stopTimerInertia = false;
+    
+    pendingDirection = DIR_STOP;
+    pendingTargetFine = 0;
+    pendingDeadline = 0;
+    
     isCalibrated = false;
     overcurrentDetected = false;
     currentCurrent_mA = 0.0;
+    
+    if (registryCount < MOTOR_REGISTRY_SIZE) {
+        registry[registryCount++] = this;
+    }
 }
 
 void MotorController::begin() {
+    #if PWM_PER_MOTOR
+    // RPWM/LPWM dieses Treibers liegen an den bisherigen Enable-GPIOs
+    PWMController::attachOutput(pwmOutput, pinREN, pinLEN);
+    #else
     pinMode(pinREN, OUTPUT);
     pinMode(pinLEN, OUTPUT);
     digitalWrite(pinREN, LOW);
     digitalWrite(pinLEN, LOW);
+    #endif
     
     // INA219 initialisieren (nur wenn aktiviert)
     #if INA219_ENABLED
-    if (!ina219->begin()) {
+    currentChannel = CurrentSampler::addSensor(inaAddress);
+    if (currentChannel < 0) {
         Serial.printf("Motor %d: INA219 (0x%02X) nicht gefunden!\n", id, inaAddress);
     } else {
         Serial.printf("Motor %d: INA219 (0x%02X) initialisiert\n", id, inaAddress);
@@ -222,13 +719,72 @@ void MotorController::begin() {
     Serial.printf("Motor %d: INA219 deaktiviert (kein Überstromschutz)\n", id);
     #endif
     
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = onStopTimer;
+    timerArgs.arg = this;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "motor_stop";
+    esp_timer_create(&timerArgs, &stopTimer);
+    
     Serial.printf("Motor %d: Initialisiert\n", id);
     
     loadConfig();
 }
 
 void MotorController::loop() {
-    if (state == STOPPED) return;
+    if (state == STOPPED) {
+        if (calPhase != CAL_IDLE) continueCalibration();
+        return;
+    }
+    
+    // Relais schaltet noch ein: Fahrbefehl ist vorgemerkt, Zeitmessung startet mit Motorspannung
+    if (!PWMController::isRelayReady()) return;
+    
+    unsigned long readyTime = PWMController::getRelayReadyTime();
+    if ((long)(moveStartTime - readyTime) < 0) {
+        moveStartTime = readyTime;
+        lastPositionUpdate = readyTime;
+        lastCurrentCheck = readyTime;
+    }
+    
+    // Sanftstopp: die Rampe steckt im Fahrweg-Integral, halt() schreibt die Position fort.
+    // Kein Nachlauf - der Motor steht schon, bevor die PWM unter die Haftreibung fällt.
+    // Abgebrochene Rampe (neuer Motor am Ausgang) ebenfalls sofort beenden.
+    if (state == STOPPING) {
+        if (PWMController::isSoftStopDone(pwmOutput) || !PWMController::isSoftStopActive(pwmOutput)) {
+            halt();
+        }
+        return;
+    }
+    
+    // Stopp-Timer hat abgeschaltet oder den Sanftstopp gestartet: Motor läuft
+    // mit der Trägheit genau ins Ziel aus - nur noch Buchhaltung
+    if (stopTimerFired) {
+        stopTimerFired = false;
+        stopTimerArmed = false;
+        if (PWMController::isSoftStopActive(pwmOutput) || PWMController::isSoftStopDone(pwmOutput)) {
+            state = STOPPING;
+            Serial.printf("Motor %d: Sanftstopp vor Ziel\n", id);
+            Scheduler::wake(statusTask);
+            Scheduler::wake(schedulerTask);
+            return;
+        }
+        // Harter Stopp aus voller Fahrt ab einer Endlage: Nachlauf an der nächsten Endlage messen
+        bool probe = stopTimerInertia && travelFromEndStop && calPhase == CAL_IDLE;
+        MotorDirection probeDir = currentDirection;
+        uint32_t probeScale = loadScale;
+        positionFine = targetFine;
+        positionRemainder = 0;
+        lastPositionUpdate = millis();
+        lastTravelUs = PWMController::getTravelUs(pwmOutput);   // Ausgang läuft ggf. für andere Motoren weiter
+        halt();
+        if (probe) {
+            inertiaProbeDir = probeDir;
+            inertiaProbeFine = positionFine;
+            inertiaProbeScale = probeScale;
+        }
+        return;
+    }
     
     unsigned long now = millis();
     
@@ -236,41 +792,201 @@ void MotorController::loop() {
     if (now - lastCurrentCheck >= CURRENT_CHECK_INTERVAL) {
         checkCurrent();
         lastCurrentCheck = now;
+        if (state == STOPPED) return;
     }
     
-    if (now - lastPositionUpdate >= POSITION_UPDATE_INTERVAL) {
-        updatePosition();
-        lastPositionUpdate = now;
-    }
+    // Position bei jedem Aufruf fortschreiben (Scheduler ruft zum Zielzeitpunkt auf)
+    updatePosition();
     
-    if (state == OPENING || state == CLOSING) {
-        if (currentPosition == targetPosition) {
-            stop();
+    // Fahrt in die Endlage: Abschaltung durch die Endlagenerkennung. Bleibt sie aus,
+    // begrenzt ein Zuschlag auf die geschätzte Fahrzeit die Suche.
+    if (seeksEndStop()) {
+        bool reached = (state == OPENING) ? positionFine >= targetFine : positionFine <= targetFine;
+        if (reached && endStopOverrunStart == 0) {
+            endStopOverrunStart = now;
+        }
+        // Ohne gelernte Fahrzeit gibt es keine Schätzung - dann begrenzt nur MAX_RUNTIME_MS
+        unsigned long travelTime = getTravelTime();
+        if (endStopOverrunStart != 0 && travelTime > 0 &&
+            now - endStopOverrunStart > travelTime * ENDSTOP_OVERRUN_PERCENT / 100) {
+            Serial.printf("Motor %d: Keine Endlage erkannt - Abschaltung nach Zuschlag\n", id);
+            halt();
+            return;
+        }
+    } else {
+        // Neu planen: Sanftanlauf vorbei (war nur vorausgerechnet) oder Last hat sich geändert
+        if (stopTimerArmed && !stopTimerFired && !stopTimerHardPhase &&
+            ((stopTimerRampPlanned && !PWMController::isSoftStartActive(pwmOutput)) ||
+             abs((int32_t)loadScale - (int32_t)stopTimerScale) * 100 > (int32_t)stopTimerScale * KINEMATIC_REPLAN_PERCENT)) {
+            disarmStopTimer();
+            armStopTimer();
+        }
+        
+        // Stoppzeitpunkt vorausberechnen, sobald die Fahrt tatsächlich läuft
+        if ((state == OPENING || state == CLOSING) && !stopTimerArmed) {
+            armStopTimer();
+        }
+        
+        // Rückfallebene ohne Timer: Ziel im Loop erkennen
+        if ((state == OPENING || state == CLOSING) && !stopTimerArmed) {
+            bool reached = (state == OPENING) ? positionFine >= targetFine : positionFine <= targetFine;
+            if (reached) {
+                positionFine = targetFine;
+                halt();
+                return;
+            }
         }
     }
     
     if (now - moveStartTime > MAX_RUNTIME_MS) {
         Serial.printf("Motor %d: Maximale Laufzeit überschritten!\n", id);
-        stop();
+        halt();
+    }
+}
+
+uint32_t MotorController::msUntilNextUpdate() {
+    if (state == STOPPED || state == STOPPING) return UINT32_MAX;    // Rampen-Timer weckt am Ende des Sanftstopps
+    if (!PWMController::isRelayReady()) return UINT32_MAX;     // PWMController weckt bei Bereitschaft
+    
+    unsigned long now = millis();
+    unsigned long sincePosition = now - lastPositionUpdate;
+    unsigned long sinceCurrent = now - lastCurrentCheck;
+    
+    uint32_t positionWait = sincePosition >= POSITION_UPDATE_INTERVAL ? 0 : POSITION_UPDATE_INTERVAL - sincePosition;
+    uint32_t currentWait = sinceCurrent >= CURRENT_CHECK_INTERVAL ? 0 : CURRENT_CHECK_INTERVAL - sinceCurrent;
+    uint32_t wait = min(positionWait, currentWait);
+    
+    // Exakt zum Erreichen des Ziels aufwachen statt auf den nächsten 100ms-Takt zu warten
+    // (mit Stopp-Timer weckt dessen Callback den Scheduler)
+    unsigned long travelTime = getTravelTime();
+    if ((state == OPENING || state == CLOSING) && travelTime > 0 && !stopTimerArmed && !seeksEndStop()) {
+        uint64_t remainingUs = remainingTravelUs();
+        uint64_t pendingUs = PWMController::getTravelUs(pwmOutput) - lastTravelUs;
+        remainingUs = remainingUs > pendingUs ? remainingUs - pendingUs : 0;
+        uint32_t targetWait = (uint32_t)((PWMController::predictTimeUs(pwmOutput, remainingUs) + 999) / 1000);
+        wait = min(wait, max(targetWait, (uint32_t)1));
     }
+    
+    return wait;
+}
+
+void MotorController::armStopTimer() {
+    if (!stopTimer || getTravelTime() == 0) return;
+    
+    // Abschaltpunkt vorziehen um den Weg der Sanftstopp-Rampe (ab der PWM nach dem
+    // Sanftanlauf). Nachlauf nur, wenn hart abgeschaltet wird (Ausgang geteilt) - eine
+    // Rampe bremst den Motor, bevor sie unter die Haftreibung fällt.
+    uint64_t remainingUs = remainingTravelUs();
+    uint64_t leadUs = (uint64_t)PWMController::getSoftStopTravelMs(pwmOutput, SOFT_START_MAX_PWM) * 1000ULL;
+    bool inertia = (leadUs == 0 || PWMController::getMotorCount(pwmOutput) > 1);
+    if (inertia) {
+        leadUs += (uint64_t)stopInertiaMs * 1000ULL;
+    }
+    
+    // Wandzeit über die restliche Sanftanlauf-Rampe vorausrechnen
+    uint64_t timeoutUs = 1;
+    if (remainingUs > leadUs) {
+        timeoutUs = PWMController::predictTimeUs(pwmOutput, remainingUs - leadUs);
+        if (timeoutUs == 0) return;         // PWM steht - Ziel im Loop erkennen
+    }
+    
+    stopTimerFired = false;
+    stopTimerHardPhase = false;
+    stopTimerScale = loadScale;
+    stopTimerRampPlanned = PWMController::isSoftStartActive(pwmOutput);
+    stopTimerInertia = inertia && remainingUs > leadUs && !stopTimerRampPlanned;
+    if (esp_timer_start_once(stopTimer, timeoutUs) == ESP_OK) {
+        stopTimerArmed = true;
+        Serial.printf("Motor %d: Stopp in %llums geplant\n", id, (unsigned long long)(timeoutUs / 1000));
+    }
+}
+
+void MotorController::disarmStopTimer() {
+    if (stopTimerArmed) {
+        esp_timer_stop(stopTimer);
+        stopTimerArmed = false;
+    }
+    stopTimerHardPhase = false;
+}
+
+// Läuft im esp_timer-Task: Sanftstopp starten oder Treiber abschalten, dann den Hauptloop wecken
+void MotorController::onStopTimer(void* arg) {
+    MotorController* motor = (MotorController*)arg;
+    
+    if (SOFT_STOP_ENABLED && !motor->stopTimerHardPhase) {
+        if (PWMController::startSoftStop(motor->pwmOutput)) {
+            motor->stopTimerFired = true;
+            Scheduler::wake(schedulerTask);
+            return;
+        }
+        // Ausgang geteilt: mit laufender PWM bis zum eigentlichen Abschaltpunkt weiterfahren
+        uint64_t travelUs = (uint64_t)PWMController::getSoftStopTravelMs(motor->pwmOutput, SOFT_START_MAX_PWM) * 1000ULL;
+        uint64_t waitUs = PWMController::predictTimeUs(motor->pwmOutput, travelUs);
+        if (waitUs > 0) {
+            motor->stopTimerHardPhase = true;
+            esp_timer_start_once(motor->stopTimer, waitUs);
+            return;
+        }
+    }
+    
+    #if PWM_PER_MOTOR
+    PWMController::cutOutput(motor->pwmOutput);
+    #else
+    digitalWrite(motor->pinREN, LOW);
+    digitalWrite(motor->pinLEN, LOW);
+    #endif
+    motor->stopTimerFired = true;
+    Scheduler::wake(schedulerTask);
+}
+
+unsigned long MotorController::getTravelTime() {
+    return (currentDirection == DIR_OPEN) ? openTime : closeTime;
+}
+
+// Restweg bis zum Ziel als Fahrweg des PWM-Ausgangs (µs bei voller PWM, Referenzlast)
+uint64_t MotorController::remainingTravelUs() {
+    uint64_t totalUs = (uint64_t)getTravelTime() * 1000ULL;
+    uint64_t scaled = (uint64_t)abs(targetFine - positionFine) * totalUs;
+    scaled = scaled > positionRemainder ? scaled - positionRemainder : 0;
+    uint64_t loadedUs = (scaled + POSITION_FINE_MAX - 1) / POSITION_FINE_MAX;
+    return (loadedUs << 16) / loadScale;
 }
 
 void MotorController::updatePosition() {
-    if (state == STOPPED) return;
+    lastPositionUpdate = millis();
     
-    unsigned long elapsed = millis() - moveStartTime;
-    unsigned long totalTime = (state == OPENING || state == LEARNING_OPEN) ? openTime : closeTime;
+    // Fahrweg des PWM-Ausgangs seit dem letzten Aufruf: Tastgrad inkl. Rampen und Haftreibung
+    uint64_t travelUs = PWMController::getTravelUs(pwmOutput);
+    uint64_t deltaUs = travelUs - lastTravelUs;
+    lastTravelUs = travelUs;
     
+    if (state == STOPPED || deltaUs == 0) return;
+    
+    unsigned long totalTime = getTravelTime();
     if (totalTime == 0) return;
     
-    if (state == OPENING || state == LEARNING_OPEN) {
-        currentPosition = min((uint8_t)100, (uint8_t)((elapsed * 100) / totalTime));
-    } else if (state == CLOSING || state == LEARNING_CLOSE) {
-        currentPosition = max((uint8_t)0, (uint8_t)(100 - ((elapsed * 100) / totalTime)));
+    // Mehr Last als bei der gelernten Fahrt = langsamer
+    deltaUs = (deltaUs * loadScale) >> 16;
+    
+    // Inkrementell ab der letzten bekannten Position integrieren (Festkomma, Rest mitführen)
+    uint64_t totalUs = (uint64_t)totalTime * 1000ULL;
+    uint64_t scaled = deltaUs * POSITION_FINE_MAX + positionRemainder;
+    int32_t delta = (int32_t)min(scaled / totalUs, (uint64_t)POSITION_FINE_MAX);
+    positionRemainder = scaled % totalUs;
+    travelFine += delta;
+    
+    if (currentDirection == DIR_OPEN) {
+        positionFine = min(positionFine + delta, (int32_t)POSITION_FINE_MAX);
+    } else if (currentDirection == DIR_CLOSE) {
+        positionFine = max(positionFine - delta, (int32_t)0);
     }
 }
 
 void MotorController::applyMotorControl(MotorDirection dir) {
+    #if PWM_PER_MOTOR
+    // Richtung und Tastgrad kommen vollständig vom eigenen PWM-Ausgang
+    (void)dir;
+    #else
     switch(dir) {
         case DIR_OPEN:
             digitalWrite(pinREN, HIGH);
@@ -286,6 +1002,7 @@ void MotorController::applyMotorControl(MotorDirection dir) {
             digitalWrite(pinLEN, LOW);
             break;
     }
+    #endif
 }
 
 void MotorController::checkCurrent() {
@@ -295,7 +1012,51 @@ void MotorController::checkCurrent() {
     return;
     #endif
     
-    currentCurrent_mA = ina219->getCurrent_mA();
+    // Aufgelaufene Werte des Sampler-Tasks abholen - kein I2C im Hauptloop
+    CurrentSample sample;
+    bool updated = false;
+    
+    // Laststrom fürs Fahrzeitmodell nur eingeschwungen: volle PWM seit der Ausblendzeit und
+    // einigen Nachlauf-Zeiten (träger Motor holt die Rampe erst dann ein), kein Anstieg zur
+    // Endlage (Anlauf- und Blockierstrom verfälschen die Last)
+    bool fullPwm = PWMController::getCurrentPWM(pwmOutput) == SOFT_START_MAX_PWM &&
+                   !PWMController::isSoftStartActive(pwmOutput) && state != STOPPING;
+    if (!fullPwm) {
+        fullPwmSince = 0;
+    } else if (fullPwmSince == 0) {
+        fullPwmSince = millis();
+    }
+    bool loadSettled = fullPwm && millis() - fullPwmSince >= max((uint32_t)ENDSTOP_BLANKING_MS, (uint32_t)stopInertiaMs * KINEMATIC_SETTLE_INERTIA);
+    
+    while (CurrentSampler::read(currentChannel, &sample)) {
+        currentCurrent_mA += (sample.current_mA - currentCurrent_mA) * CURRENT_FILTER_ALPHA;
+        if (ENDSTOP_DETECTION_ENABLED && endStop.update(sample.timeUs, sample.current_mA)) {
+            endStopDetected = true;
+        }
+        if (loadSettled && endStop.getCusum() == 0.0) {
+            float load = abs(sample.current_mA);
+            if (loadMeasured) {
+                float& filtered = load_mA[currentDirection == DIR_OPEN ? 0 : 1];
+                filtered += (load - filtered) * KINEMATIC_LOAD_ALPHA;
+            }
+            loadSum += load;
+            loadCount++;
+        }
+        updated = true;
+    }
+    if (!updated) return;
+    
+    if (loadMeasured) {
+        updateLoadScale();
+    } else if (loadCount >= KINEMATIC_LOAD_SAMPLES) {
+        measureLoad();
+    }
+    
+    if (endStopDetected) {
+        endStopDetected = false;
+        handleEndStop();
+        return;
+    }
     
     // INA219 kann negative Werte liefern (Stromrichtung!)
     // Für Überstromprüfung Absolutwert verwenden
@@ -309,7 +1070,8 @@ void MotorController::checkCurrent() {
         } else if (millis() - overcurrentStartTime >= OVERCURRENT_TIME_MS) {
             overcurrentDetected = true;
             Serial.printf("Motor %d: ÜBERSTROM ABSCHALTUNG! (%.0f mA)\n", id, currentCurrent_mA);
-            stop();
+            emitEvent(MOTOR_EVENT_OVERCURRENT);
+            halt();
         }
     } else {
         overcurrentStartTime = 0;
@@ -320,105 +1082,470 @@ void MotorController::checkCurrent() {
     }
 }
 
+// Fahrtbeginn: Werte aus dem Stillstand verwerfen, Filter neu starten
+void MotorController::resetCurrentFilter() {
+    CurrentSampler::flush(currentChannel);
+    currentCurrent_mA = 0.0;
+    overcurrentStartTime = 0;
+    endStop.reset();
+    endStopDetected = false;
+    endStopOverrunStart = 0;
+    
+    // Laststrom der letzten Fahrt dieser Richtung gilt, bis neue Werte eingeschwungen sind
+    loadSum = 0.0;
+    loadCount = 0;
+    loadMeasured = false;
+    fullPwmSince = 0;
+    loadScale = computeLoadScale();
+    travelFine = 0;
+    lastTravelUs = PWMController::getTravelUs(pwmOutput);
+}
+
+// Lastfaktor (Q16) aus dem Verhältnis zum Referenzstrom der gelernten Fahrzeit
+uint32_t MotorController::computeLoadScale() {
+    uint8_t dir = (currentDirection == DIR_OPEN) ? 0 : 1;
+    if (loadRef_mA[dir] <= 0.0 || load_mA[dir] <= 0.0) return 1UL << 16;
+    
+    float scale = 1.0 / (1.0 + KINEMATIC_LOAD_GAIN * (load_mA[dir] / loadRef_mA[dir] - 1.0));
+    scale = constrain(scale, KINEMATIC_SCALE_MIN, KINEMATIC_SCALE_MAX);
+    return (uint32_t)(scale * 65536.0);
+}
+
+// Erste eingeschwungene Last dieser Fahrt: bis hierhin galt die Last der letzten Fahrt -
+// den Weg seit Fahrtbeginn (inkl. Sanftanlauf) mit dem neuen Faktor nachrechnen
+void MotorController::measureLoad() {
+    load_mA[currentDirection == DIR_OPEN ? 0 : 1] = loadSum / loadCount;
+    loadMeasured = true;
+    
+    updatePosition();
+    uint32_t scale = computeLoadScale();
+    int32_t correction = ((int64_t)travelFine * ((int64_t)scale - (int64_t)loadScale)) / (int64_t)loadScale;
+    travelFine += correction;
+    positionFine += (currentDirection == DIR_OPEN) ? correction : -correction;
+    positionFine = constrain(positionFine, (int32_t)0, (int32_t)POSITION_FINE_MAX);
+    loadScale = scale;
+}
+
+void MotorController::updateLoadScale() {
+    // Bisherigen Abschnitt noch mit dem alten Faktor integrieren
+    updatePosition();
+    loadScale = computeLoadScale();
+}
+
+// Fahrt von Endlage zu Endlage: das Modell hätte genau 100% integrieren müssen. Die
+// Abweichung führt die Fahrzeit nach, der Referenzstrom bleibt (Fahrzeit gilt bei ihm).
+void MotorController::refineTravelModel() {
+    bool opening = (currentDirection == DIR_OPEN);
+    unsigned long& travelTime = opening ? openTime : closeTime;
+    if (travelTime == 0) return;
+    
+    // Integriert ist der angesteuerte Weg bis zur Erkennung: der Motor läuft ihm um den
+    // Nachlauf hinterher und steht seit dem Beginn des Stromanstiegs
+    uint32_t lagMs = stopInertiaMs + (micros() - endStop.getOnsetUs()) / 1000;
+    int32_t measuredFine = travelFine - (int32_t)(((uint64_t)lagMs * POSITION_FINE_MAX) / travelTime);
+    int32_t deviation = measuredFine - POSITION_FINE_MAX;
+    
+    if (measuredFine <= 0 || abs(deviation) > KINEMATIC_ADAPT_LIMIT * POSITION_FINE_SCALE) {
+        Serial.printf("Motor %d: Fahrzeitmodell - Abweichung %d%% unplausibel, nicht nachgeführt\n",
+                     id, deviation / POSITION_FINE_SCALE);
+        return;
+    }
+    
+    unsigned long measured = ((uint64_t)travelTime * measuredFine) / POSITION_FINE_MAX;
+    unsigned long refined = travelTime + ((long)measured - (long)travelTime) * KINEMATIC_ADAPT_PERCENT / 100;
+    Serial.printf("Motor %d: Fahrzeitmodell %s %lums -> %lums (Abweichung %+.2f%%)\n", id,
+                 opening ? "Öffnen" : "Schließen", travelTime, refined, deviation / (float)POSITION_FINE_SCALE);
+    travelTime = refined;
+    
+    uint8_t dir = opening ? 0 : 1;
+    if (loadRef_mA[dir] <= 0.0 && loadCount > 0) {
+        loadRef_mA[dir] = loadSum / loadCount;
+    }
+    saveConfig();
+}
+
+// Fahrt vom Messpunkt eines harten Stopps in die Endlage: der Weg bis zur Endlage zeigt,
+// wo der Motor nach dem Stopp wirklich stand. Ist er weiter ausgelaufen als angenommen,
+// ist der Weg in Stopprichtung kürzer und in Gegenrichtung länger.
+void MotorController::learnStopInertia(int32_t endPosition) {
+    bool opening = (currentDirection == DIR_OPEN);
+    unsigned long travelTime = getTravelTime();
+    unsigned long probeTime = (inertiaProbeDir == DIR_OPEN) ? openTime : closeTime;
+    if (travelTime == 0 || probeTime == 0) return;
+    
+    // Wie refineTravelModel: dem angesteuerten Weg läuft der Motor um den Nachlauf hinterher.
+    // Ein falscher Nachlauf geht so doppelt in die Messung ein (Stopp und Abzug hier) -
+    // STOP_INERTIA_ADAPT_PERCENT 25 halbiert den Fehler pro Messung.
+    uint32_t lagMs = stopInertiaMs + (micros() - endStop.getOnsetUs()) / 1000;
+    int32_t measuredFine = travelFine - (int32_t)(((uint64_t)lagMs * POSITION_FINE_MAX) / travelTime);
+    int32_t expectedFine = abs(endPosition - inertiaProbeFine);
+    int32_t excessFine = measuredFine - expectedFine;
+    if ((inertiaProbeDir == DIR_OPEN) == opening) excessFine = -excessFine;
+    
+    if (abs(excessFine) > KINEMATIC_ADAPT_LIMIT * POSITION_FINE_SCALE) {
+        Serial.printf("Motor %d: Nachlauf - Abweichung %d%% unplausibel, nicht nachgeführt\n",
+                     id, excessFine / POSITION_FINE_SCALE);
+        return;
+    }
+    
+    // Weg -> Zeit bei voller Geschwindigkeit und Referenzlast (langsamer = kürzerer Nachlauf)
+    int32_t excessMs = (int32_t)(((int64_t)excessFine * (int64_t)probeTime * 65536LL) /
+                                 ((int64_t)POSITION_FINE_MAX * (int64_t)inertiaProbeScale));
+    int32_t measured = constrain((int32_t)stopInertiaMs + excessMs, (int32_t)0, (int32_t)STOP_INERTIA_MAX_MS);
+    uint16_t refined = stopInertiaMs + (measured - (int32_t)stopInertiaMs) * STOP_INERTIA_ADAPT_PERCENT / 100;
+    Serial.printf("Motor %d: Nachlauf %ums -> %ums (gemessen %ldms)\n", id, stopInertiaMs, refined, (long)measured);
+    
+    inertiaProbeDir = DIR_STOP;
+    if (refined == stopInertiaMs) return;
+    stopInertiaMs = refined;
+    saveConfig();
+}
+
+// Fahrt auf 0/100%: bis zur erkannten Endlage fahren statt zur geschätzten Position
+bool MotorController::seeksEndStop() {
+    if (!ENDSTOP_DETECTION_ENABLED || currentChannel < 0) return false;
+    return (state == OPENING && targetFine == POSITION_FINE_MAX) ||
+           (state == CLOSING && targetFine == 0);
+}
+
+void MotorController::handleEndStop() {
+    bool opening = (currentDirection == DIR_OPEN);
+    int32_t endPosition = opening ? POSITION_FINE_MAX : 0;
+    
+    if (state == LEARNING_OPEN || state == LEARNING_CLOSE) {
+        if (calPhase != CAL_IDLE) {
+            advanceCalibration();
+            return;
+        }
+        Serial.printf("Motor %d: Endlage erkannt (%.0f mA) - Anlernen abgeschlossen\n", id, currentCurrent_mA);
+        finishLearn();
+        return;
+    }
+    if (state != OPENING && state != CLOSING) return;
+    
+    updatePosition();
+    int32_t error = endPosition - positionFine;
+    
+    // Weit weg von der Endlage: Hindernis, Position nicht überschreiben
+    if (abs(error) > ENDSTOP_RESYNC_WINDOW * POSITION_FINE_SCALE) {
+        Serial.printf("Motor %d: Blockade bei %d%% (%.0f mA) - angehalten\n", id, getPosition(), currentCurrent_mA);
+        halt();
+        return;
+    }
+    
+    Serial.printf("Motor %d: Endlage erkannt bei geschätzt %d.%03d%% -> %d%%\n", id,
+                 positionFine / POSITION_FINE_SCALE, positionFine % POSITION_FINE_SCALE,
+                 endPosition / POSITION_FINE_SCALE);
+    if (travelFromEndStop) {
+        refineTravelModel();
+    } else if (inertiaProbeDir != DIR_STOP) {
+        learnStopInertia(endPosition);
+    }
+    positionFine = endPosition;
+    positionAtEndStop = true;
+    positionRemainder = 0;
+    targetFine = endPosition;
+    halt();
+}
+
 void MotorController::moveToPosition(uint8_t position) {
     if (!isCalibrated) {
         Serial.printf("Motor %d: Nicht kalibriert!\n", id);
         return;
     }
     
-    targetPosition = constrain(position, 0, 100);
+    targetFine = (int32_t)constrain(position, 0, 100) * POSITION_FINE_SCALE;
     
-    if (targetPosition > currentPosition) {
-        open();
-    } else if (targetPosition < currentPosition) {
-        close();
+    if (targetFine > positionFine) {
+        startMove(DIR_OPEN);
+    } else if (targetFine < positionFine) {
+        startMove(DIR_CLOSE);
+    } else {
+        // Schon am Ziel: ein vorgemerkter älterer Befehl ist überholt
+        pendingDirection = DIR_STOP;
     }
 }
 
+MotorDirection MotorController::directionTo(uint8_t position) {
+    int32_t target = (int32_t)constrain(position, 0, 100) * POSITION_FINE_SCALE;
+    if (target > positionFine) return DIR_OPEN;
+    if (target < positionFine) return DIR_CLOSE;
+    return DIR_STOP;
+}
+
+uint32_t MotorController::estimateMoveTo(uint8_t position) {
+    MotorDirection dir = directionTo(position);
+    if (dir == DIR_STOP) return 0;
+    return estimateMoveTime(dir, (int32_t)constrain(position, 0, 100) * POSITION_FINE_SCALE);
+}
+
 void MotorController::open() {
-    if (PWMController::hasConflict()) {
-        Serial.printf("Motor %d: Konflikt - andere Richtung aktiv!\n", id);
+    targetFine = POSITION_FINE_MAX;
+    startMove(DIR_OPEN);
+}
+
+void MotorController::close() {
+    targetFine = 0;
+    startMove(DIR_CLOSE);
+}
+
+void MotorController::startMove(MotorDirection dir) {
+    // Gleiche Richtung: nur das Ziel hat sich geändert - Stoppzeit neu berechnen
+    if ((dir == DIR_OPEN && state == OPENING) || (dir == DIR_CLOSE && state == CLOSING)) {
+        if (stopTimerArmed && !stopTimerFired) {
+            disarmStopTimer();
+            updatePosition();
+            armStopTimer();
+        }
+        Serial.printf("Motor %d: Neues Ziel %d.%03d%%\n", id, targetFine / POSITION_FINE_SCALE, targetFine % POSITION_FINE_SCALE);
+        Scheduler::wake(schedulerTask);
         return;
     }
     
-    Serial.printf("Motor %d: Öffne auf %d%%\n", id, targetPosition);
+    // Richtungswechsel (oder neuer Befehl im Sanftstopp): sofort anhalten
+    if (state != STOPPED) {
+        halt();
+    }
     
-    state = OPENING;
-    currentDirection = DIR_OPEN;
-    moveStartTime = millis();
-    lastPositionUpdate = moveStartTime;
+    // Gemeinsamer Ausgang im Sanftstopp eines anderen Motors derselben Richtung: dessen
+    // Rampe würde die PWM auch für diesen Motor auf 0 fahren - den anderen hart anhalten
+    // (Position aus dem bisherigen Fahrweg-Integral). Gegenrichtung wartet unten auf ihn.
+    if (PWMController::isSoftStopActive(pwmOutput) || PWMController::isSoftStopDone(pwmOutput)) {
+        pendingDirection = DIR_STOP;    // halt() startet sonst ggf. den alten vorgemerkten Befehl
+        for (uint8_t i = 0; i < registryCount; i++) {
+            MotorController* m = registry[i];
+            if (m != this && m->pwmOutput == pwmOutput && m->state != STOPPED && m->currentDirection == dir) {
+                Serial.printf("Motor %d: Sanftstopp abgebrochen (Motor %d startet)\n", m->id, id);
+                m->halt();
+            }
+        }
+    }
     
-    applyMotorControl(DIR_OPEN);
-    PWMController::motorStarted(DIR_OPEN);
-}
-
-void MotorController::close() {
-    if (PWMController::hasConflict()) {
-        Serial.printf("Motor %d: Konflikt - andere Richtung aktiv!\n", id);
+    // Gegenrichtung läuft (gemeinsame PWM) oder wartet schon zu lange: vormerken statt verwerfen
+    if (PWMController::hasConflict(pwmOutput, dir) || isHeldBack(pwmOutput, dir)) {
+        queueCommand(dir);
         return;
     }
+    pendingDirection = DIR_STOP;
     
-    Serial.printf("Motor %d: Schließe auf %d%%\n", id, targetPosition);
+    if (dir == DIR_OPEN) {
+        Serial.printf("Motor %d: Öffne auf %d%%\n", id, targetFine / POSITION_FINE_SCALE);
+        state = OPENING;
+    } else {
+        Serial.printf("Motor %d: Schließe auf %d%%\n", id, targetFine / POSITION_FINE_SCALE);
+        state = CLOSING;
+    }
+    Scheduler::wake(statusTask);
     
-    state = CLOSING;
-    currentDirection = DIR_CLOSE;
+    currentDirection = dir;
     moveStartTime = millis();
     lastPositionUpdate = moveStartTime;
+    positionRemainder = 0;
+    travelFromEndStop = positionAtEndStop;
+    positionAtEndStop = false;
+    resetCurrentFilter();
     
-    applyMotorControl(DIR_CLOSE);
-    PWMController::motorStarted(DIR_CLOSE);
+    applyMotorControl(dir);
+    PWMController::motorStarted(pwmOutput, dir);
+    emitEvent(MOTOR_EVENT_MOVE);
+    Scheduler::wake(schedulerTask);
 }
 
 void MotorController::stop() {
-    Serial.printf("Motor %d: Stoppe bei %d%%\n", id, currentPosition);
+    // Normale Fahrt: per Rampe auslaufen, wenn der Motor den PWM-Ausgang allein nutzt
+    if (state == OPENING || state == CLOSING) {
+        disarmStopTimer();
+        stopTimerFired = false;
+        updatePosition();
+        
+        if (PWMController::startSoftStop(pwmOutput)) {
+            // Voraussichtliches Ziel (Anzeige) - die Position integriert die Rampe selbst
+            uint64_t travelMs = PWMController::getSoftStopTravelMs(pwmOutput, PWMController::getCurrentPWM(pwmOutput));
+            unsigned long travelTime = getTravelTime();
+            int32_t distance = travelTime > 0 ? (((travelMs * loadScale) >> 16) * POSITION_FINE_MAX) / travelTime : 0;
+            targetFine = (state == OPENING) ? min(positionFine + distance, (int32_t)POSITION_FINE_MAX)
+                                            : max(positionFine - distance, (int32_t)0);
+            state = STOPPING;
+            pendingDirection = DIR_STOP;
+            Scheduler::wake(statusTask);
+            Serial.printf("Motor %d: Sanftstopp\n", id);
+            Scheduler::wake(schedulerTask);
+            return;
+        }
+    }
+    
+    halt();
+}
+
+// Sofort abschalten (Überstrom, Laufzeit, Richtungswechsel, Ende Sanftstopp)
+void MotorController::halt() {
+    // Jeder Stopp außerhalb der Kalibrierschritte (Taster, Befehl, Überstrom, Laufzeit) bricht sie ab
+    if (calPhase != CAL_IDLE && !calStepDone) {
+        Serial.printf("Motor %d: Automatische Kalibrierung abgebrochen\n", id);
+        calPhase = CAL_IDLE;
+    }
+    
+    disarmStopTimer();
+    stopTimerFired = false;
+    inertiaProbeDir = DIR_STOP;         // Fahrt ab dem Messpunkt ist vorbei
+    
+    // Letztes Teilstück bis zum Stoppzeitpunkt noch mitnehmen
+    updatePosition();
+    
+    Serial.printf("Motor %d: Stoppe bei %d.%03d%%\n", id, positionFine / POSITION_FINE_SCALE, positionFine % POSITION_FINE_SCALE);
     
     MotorDirection oldDirection = currentDirection;
     
     state = STOPPED;
     currentDirection = DIR_STOP;
+    Scheduler::wake(statusTask);
     
     applyMotorControl(DIR_STOP);
-    PWMController::motorStopped(oldDirection);
+    PWMController::motorStopped(pwmOutput, oldDirection);
+    
+    emitEvent(MOTOR_EVENT_STOP);
+    
+    // Expliziter Stopp verwirft auch einen vorgemerkten Befehl
+    pendingDirection = DIR_STOP;
+    dispatchPending(pwmOutput);
+    
+    Scheduler::wake(schedulerTask);
+}
+
+// ===== Richtungs-Arbitrierung =====
+// Bei gemeinsamer PWM kann ein Ausgang nur eine Richtung treiben. Befehle gegen die
+// laufende Richtung werden vorgemerkt und laufen als Richtungs-Block, sobald die
+// Gegenrichtung abgelaufen ist. Sind beide Richtungen vorgemerkt, startet der Block
+// mit der kürzeren Fahrzeit zuerst (minimale Summe der Fertigstellungszeiten).
+// Überschreitet ein vorgemerkter Befehl seine Frist, starten keine neuen Fahrten
+// der laufenden Richtung mehr, damit sie abläuft.
+
+void MotorController::queueCommand(MotorDirection dir) {
+    if (pendingDirection != dir) {
+        pendingDeadline = millis() + ARBITRATION_DEADLINE_MS;
+    }
+    pendingDirection = dir;
+    pendingTargetFine = targetFine;
+    Serial.printf("Motor %d: Fahrt auf %d%% vorgemerkt (Richtungs-Arbitrierung)\n", id, targetFine / POSITION_FINE_SCALE);
+}
+
+uint32_t MotorController::estimateMoveTime(MotorDirection dir, int32_t target) {
+    unsigned long travelTime = (dir == DIR_OPEN) ? openTime : closeTime;
+    if (travelTime == 0) travelTime = MAX_RUNTIME_MS;
+    uint32_t remaining = abs(target - positionFine);
+    return ((uint64_t)remaining * travelTime) / POSITION_FINE_MAX;
+}
+
+bool MotorController::isHeldBack(uint8_t output, MotorDirection dir) {
+    MotorDirection opposite = (dir == DIR_OPEN) ? DIR_CLOSE : DIR_OPEN;
+    if (!PWMController::hasConflict(output, opposite)) return false;   // Ausgang läuft nicht in dir
+    
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < registryCount; i++) {
+        MotorController* m = registry[i];
+        if (m->pwmOutput == output && m->pendingDirection == opposite &&
+            (long)(now - m->pendingDeadline) >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MotorController::dispatchPending(uint8_t output) {
+    unsigned long now = millis();
+    uint32_t batchTime[3] = {0, 0, 0};          // Index = MotorDirection
+    bool overdue[3] = {false, false, false};
+    uint8_t pendingCount[3] = {0, 0, 0};
+    
+    for (uint8_t i = 0; i < registryCount; i++) {
+        MotorController* m = registry[i];
+        if (m->pwmOutput != output || m->pendingDirection == DIR_STOP) continue;
+        MotorDirection dir = m->pendingDirection;
+        batchTime[dir] = max(batchTime[dir], m->estimateMoveTime(dir, m->pendingTargetFine));
+        if ((long)(now - m->pendingDeadline) >= 0) overdue[dir] = true;
+        pendingCount[dir]++;
+    }
+    if (pendingCount[DIR_OPEN] + pendingCount[DIR_CLOSE] == 0) return;
+    
+    MotorDirection batch;
+    if (PWMController::hasConflict(output, DIR_CLOSE)) {
+        batch = DIR_OPEN;                       // Öffnen läuft: nur zurückgehaltene Öffnen-Befehle
+    } else if (PWMController::hasConflict(output, DIR_OPEN)) {
+        batch = DIR_CLOSE;
+    } else if (pendingCount[DIR_OPEN] == 0) {
+        batch = DIR_CLOSE;
+    } else if (pendingCount[DIR_CLOSE] == 0) {
+        batch = DIR_OPEN;
+    } else if (overdue[DIR_OPEN] != overdue[DIR_CLOSE]) {
+        batch = overdue[DIR_OPEN] ? DIR_OPEN : DIR_CLOSE;
+    } else {
+        batch = (batchTime[DIR_OPEN] <= batchTime[DIR_CLOSE]) ? DIR_OPEN : DIR_CLOSE;
+    }
+    
+    if (pendingCount[batch] == 0 || isHeldBack(output, batch)) return;
+    
+    Serial.printf("Arbitrierung: starte vorgemerkte %s-Fahrten (max. %lums)\n",
+                 batch == DIR_OPEN ? "AUF" : "ZU", (unsigned long)batchTime[batch]);
+    
+    for (uint8_t i = 0; i < registryCount; i++) {
+        MotorController* m = registry[i];
+        if (m->pwmOutput != output || m->pendingDirection != batch) continue;
+        m->targetFine = m->pendingTargetFine;
+        m->pendingDirection = DIR_STOP;
+        m->startMove(batch);
+    }
 }
 
 void MotorController::startLearnOpen() {
     Serial.printf("Motor %d: Lerne Öffnungszeit\n", id);
     
     state = LEARNING_OPEN;
+    Scheduler::wake(statusTask);
     currentDirection = DIR_OPEN;
-    currentPosition = 0;
-    targetPosition = 100;
+    positionFine = 0;
+    targetFine = POSITION_FINE_MAX;
     moveStartTime = millis();
+    lastPositionUpdate = moveStartTime;
+    resetCurrentFilter();
     
     applyMotorControl(DIR_OPEN);
-    PWMController::motorStarted(DIR_OPEN);
-    PWMController::resetSoftStart();
+    PWMController::motorStarted(pwmOutput, DIR_OPEN);
+    PWMController::resetSoftStart(pwmOutput);
+    emitEvent(MOTOR_EVENT_MOVE);
+    Scheduler::wake(schedulerTask);
 }
 
 void MotorController::startLearnClose() {
     Serial.printf("Motor %d: Lerne Schließzeit\n", id);
     
     state = LEARNING_CLOSE;
+    Scheduler::wake(statusTask);
     currentDirection = DIR_CLOSE;
-    currentPosition = 100;
-    targetPosition = 0;
+    positionFine = POSITION_FINE_MAX;
+    targetFine = 0;
     moveStartTime = millis();
+    lastPositionUpdate = moveStartTime;
+    resetCurrentFilter();
     
     applyMotorControl(DIR_CLOSE);
-    PWMController::motorStarted(DIR_CLOSE);
-    PWMController::resetSoftStart();
+    PWMController::motorStarted(pwmOutput, DIR_CLOSE);
+    PWMController::resetSoftStart(pwmOutput);
+    emitEvent(MOTOR_EVENT_MOVE);
+    Scheduler::wake(schedulerTask);
 }
 
 void MotorController::finishLearn() {
-    unsigned long learnTime = millis() - moveStartTime;
+    unsigned long learnTime = measureLearnTime();
+    
+    positionAtEndStop = endStop.isTriggered();
     
     if (state == LEARNING_OPEN) {
         openTime = learnTime;
-        currentPosition = 100;
+        positionFine = POSITION_FINE_MAX;
         Serial.printf("Motor %d: Öffnungszeit: %lums (%.1fs)\n", id, openTime, openTime/1000.0);
     } else if (state == LEARNING_CLOSE) {
         closeTime = learnTime;
-        currentPosition = 0;
+        positionFine = 0;
         Serial.printf("Motor %d: Schließzeit: %lums (%.1fs)\n", id, closeTime, closeTime/1000.0);
     }
     
@@ -428,7 +1555,7 @@ void MotorController::finishLearn() {
         saveConfig();
     }
     
-    stop();
+    halt();
 }
 
 void MotorController::cancelLearn() {
@@ -436,13 +1563,150 @@ void MotorController::cancelLearn() {
     stop();
 }
 
+// Lernfahrt mit erkannter Endlage: Zeit aus den Sampler-Zeitstempeln (bestromt bis
+// Beginn des Blockierstroms), unabhängig von Loop-Takt und Erkennungsverzögerung.
+// Ohne den Anlauf-Nachlauf = Fahrzeit bei voller Geschwindigkeit (Fahrzeitmodell).
+// Der Laststrom der Fahrt wird Referenz für den Lastfaktor.
+unsigned long MotorController::measureLearnTime() {
+    if (loadCount > 0) {
+        loadRef_mA[currentDirection == DIR_OPEN ? 0 : 1] = loadSum / loadCount;
+    }
+    if (endStop.isTriggered()) {
+        unsigned long runMs = (endStop.getRunTimeUs() + 500) / 1000;
+        return runMs > stopInertiaMs ? runMs - stopInertiaMs : runMs;
+    }
+    return millis() - moveStartTime;
+}
+
+// ===== Automatische Kalibrierung =====
+// Homing in die geschlossene Endlage, dann runs x (Öffnen bis Endlage, Schließen bis
+// Endlage). Jede Phase startet aus loop(), sobald die Richtung auf dem PWM-Ausgang frei
+// ist - bei gemeinsamer PWM fahren so alle kalibrierenden Motoren dieselbe Phase
+// parallel, der schnellste wartet an der Endlage auf den langsamsten.
+
+bool MotorController::startAutoCalibration(uint8_t runs) {
+    if (!ENDSTOP_DETECTION_ENABLED || currentChannel < 0) {
+        Serial.printf("Motor %d: Automatische Kalibrierung braucht INA219 mit Endlagenerkennung\n", id);
+        return false;
+    }
+    
+    if (state != STOPPED) {
+        halt();
+    }
+    
+    calRuns = constrain(runs, 1, AUTO_CAL_MAX_RUNS);
+    calRunsDone = 0;
+    calOpenSum = calCloseSum = 0;
+    calOpenMin = calCloseMin = UINT32_MAX;
+    calOpenMax = calCloseMax = 0;
+    calPhase = CAL_HOMING;
+    
+    Serial.printf("Motor %d: Automatische Kalibrierung (%d Läufe)\n", id, calRuns);
+    continueCalibration();
+    return true;
+}
+
+void MotorController::continueCalibration() {
+    MotorDirection dir = (calPhase == CAL_OPEN) ? DIR_OPEN : DIR_CLOSE;
+    
+    // Gegenrichtung läuft auf dem gemeinsamen Ausgang: nach deren halt() erneut versuchen
+    if (PWMController::hasConflict(pwmOutput, dir)) return;
+    
+    if (dir == DIR_OPEN) {
+        startLearnOpen();
+    } else {
+        startLearnClose();
+    }
+}
+
+void MotorController::advanceCalibration() {
+    unsigned long learnTime = measureLearnTime();
+    
+    if (calPhase == CAL_HOMING) {
+        Serial.printf("Motor %d: Kalibrierung - geschlossene Endlage erreicht\n", id);
+        positionFine = 0;
+        calPhase = CAL_OPEN;
+    } else if (learnTime < AUTO_CAL_MIN_TRAVEL_MS) {
+        // Endlage direkt nach dem Anlauf: Motor stand nicht an der Gegenendlage
+        Serial.printf("Motor %d: Kalibrierung - Fahrzeit %lums unplausibel\n", id, learnTime);
+        halt();
+        return;
+    } else if (calPhase == CAL_OPEN) {
+        calOpenSum += learnTime;
+        calOpenMin = min(calOpenMin, (uint32_t)learnTime);
+        calOpenMax = max(calOpenMax, (uint32_t)learnTime);
+        Serial.printf("Motor %d: Kalibrierlauf %d/%d Öffnen: %lums\n", id, calRunsDone + 1, calRuns, learnTime);
+        positionFine = POSITION_FINE_MAX;
+        calPhase = CAL_CLOSE;
+    } else {
+        calCloseSum += learnTime;
+        calCloseMin = min(calCloseMin, (uint32_t)learnTime);
+        calCloseMax = max(calCloseMax, (uint32_t)learnTime);
+        Serial.printf("Motor %d: Kalibrierlauf %d/%d Schließen: %lums\n", id, calRunsDone + 1, calRuns, learnTime);
+        positionFine = 0;
+        calRunsDone++;
+        if (calRunsDone >= calRuns) {
+            finishCalibration();
+        } else {
+            calPhase = CAL_OPEN;
+        }
+    }
+    
+    positionRemainder = 0;
+    targetFine = positionFine;
+    positionAtEndStop = true;
+    
+    calStepDone = true;
+    halt();
+    calStepDone = false;
+}
+
+void MotorController::finishCalibration() {
+    openTime = (calOpenSum + calRuns / 2) / calRuns;
+    closeTime = (calCloseSum + calRuns / 2) / calRuns;
+    isCalibrated = true;
+    calPhase = CAL_IDLE;
+    saveConfig();
+    
+    Serial.printf("Motor %d: Kalibrierung abgeschlossen - Öffnen %lums (%lu..%lu), Schließen %lums (%lu..%lu)\n", id,
+                 openTime, (unsigned long)calOpenMin, (unsigned long)calOpenMax,
+                 closeTime, (unsigned long)calCloseMin, (unsigned long)calCloseMax);
+    
+    if ((calOpenMax - calOpenMin) * 100 > openTime * AUTO_CAL_MAX_SPREAD ||
+        (calCloseMax - calCloseMin) * 100 > closeTime * AUTO_CAL_MAX_SPREAD) {
+        Serial.printf("Motor %d: Warnung - Kalibrierläufe streuen über %d%% (Mechanik prüfen)\n", id, AUTO_CAL_MAX_SPREAD);
+    }
+}
+
+const char* MotorController::getStateName() {
+    switch (state) {
+        case OPENING:        return "opening";
+        case CLOSING:        return "closing";
+        case LEARNING_OPEN:  return "learning_open";
+        case LEARNING_CLOSE: return "learning_close";
+        case STOPPING:       return "stopping";
+        default:             return "stopped";
+    }
+}
+
+const char* MotorController::getDirectionName() {
+    switch (currentDirection) {
+        case DIR_OPEN:  return "open";
+        case DIR_CLOSE: return "close";
+        default:        return "stop";
+    }
+}
+
 void MotorController::saveConfig() {
     prefs.begin(PREFS_NAMESPACE, false);
     
     String prefix = "m" + String(id) + "_";
     prefs.putULong((prefix + "open").c_str(), openTime);
     prefs.putULong((prefix + "close").c_str(), closeTime);
-    prefs.putUChar((prefix + "pos").c_str(), currentPosition);
+    prefs.putULong((prefix + "posf").c_str(), positionFine);
+    prefs.putUShort((prefix + "inert").c_str(), stopInertiaMs);
+    prefs.putFloat((prefix + "lref_o").c_str(), loadRef_mA[0]);
+    prefs.putFloat((prefix + "lref_c").c_str(), loadRef_mA[1]);
     prefs.putBool((prefix + "cal").c_str(), isCalibrated);
     
     prefs.end();
@@ -456,19 +1720,26 @@ void MotorController::loadConfig() {
     String prefix = "m" + String(id) + "_";
     openTime = prefs.getULong((prefix + "open").c_str(), 0);
     closeTime = prefs.getULong((prefix + "close").c_str(), 0);
-    currentPosition = prefs.getUChar((prefix + "pos").c_str(), 0);
+    // "posf" = Festkomma-Position, ältere Firmware speicherte ganze Prozent unter "pos"
+    positionFine = prefs.getULong((prefix + "posf").c_str(),
+                                  prefs.getUChar((prefix + "pos").c_str(), 0) * POSITION_FINE_SCALE);
     isCalibrated = prefs.getBool((prefix + "cal").c_str(), false);
+    stopInertiaMs = prefs.getUShort((prefix + "inert").c_str(), STOP_INERTIA_MS);
+    loadRef_mA[0] = prefs.getFloat((prefix + "lref_o").c_str(), 0.0);
+    loadRef_mA[1] = prefs.getFloat((prefix + "lref_c").c_str(), 0.0);
+    positionAtEndStop = false;
     
     prefs.end();
     
     Serial.printf("Motor %d: Config geladen (Open:%lums Close:%lums Pos:%d%% Cal:%d)\n",
-                 id, openTime, closeTime, currentPosition, isCalibrated);
+                 id, openTime, closeTime, getPosition(), isCalibrated);
 }
 
 void MotorController::resetConfig() {
     openTime = 0;
     closeTime = 0;
-    currentPosition = 0;
+    positionFine = 0;
+    loadRef_mA[0] = loadRef_mA[1] = 0.0;
     isCalibrated = false;
     
     saveConfig();
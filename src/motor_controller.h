@@ -3,14 +3,38 @@
 
 #include <Arduino.h>
 #include <Preferences.h>
-#include <Adafruit_INA219.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include "config.h"
+#include "end_stop_detector.h"
+
+// Festkomma-Position: 1 Einheit = 0,001 % des Verfahrwegs
+#define POSITION_FINE_SCALE 1000
+#define POSITION_FINE_MAX (100 * POSITION_FINE_SCALE)
+
+#define MOTOR_REGISTRY_SIZE 4  // Motoren, die an der Richtungs-Arbitrierung teilnehmen
+
+#if PWM_PER_MOTOR
+#define PWM_OUTPUT_COUNT 4      // Eigenes RPWM/LPWM-Kanalpaar pro Motor
+#else
+#define PWM_OUTPUT_COUNT 1      // Ein Kanalpaar für alle Motoren
+#endif
 
 enum MotorState {
     STOPPED,
     OPENING,
     CLOSING,
     LEARNING_OPEN,
-    LEARNING_CLOSE
+    LEARNING_CLOSE,
+    STOPPING                        // Sanftstopp läuft (PWM-Rampe auf 0)
+};
+
+// Automatische Kalibrierung: erst in die geschlossene Endlage, dann N Läufe auf/zu
+enum CalibrationPhase {
+    CAL_IDLE,
+    CAL_HOMING,                     // Zur geschlossenen Endlage (Startpunkt, Zeit verworfen)
+    CAL_OPEN,
+    CAL_CLOSE
 };
 
 enum MotorDirection {
@@ -19,19 +43,48 @@ enum MotorDirection {
     DIR_CLOSE
 };
 
+// Ereignisse für das Ereignisprotokoll (MQTT)
+enum MotorEvent {
+    MOTOR_EVENT_MOVE,               // Fahrt/Lernlauf gestartet, Richtung = getDirection()
+    MOTOR_EVENT_STOP,
+    MOTOR_EVENT_OVERCURRENT         // Überstromabschaltung (danach MOTOR_EVENT_STOP)
+};
+
 class MotorController {
 private:
     uint8_t id;
     uint8_t pinREN;
     uint8_t pinLEN;
     uint8_t inaAddress;
+    uint8_t pwmOutput;
     
-    Adafruit_INA219* ina219;
+    int8_t currentChannel;          // Ringpuffer im CurrentSampler (-1 = kein Sensor)
     
     MotorState state;
     MotorDirection currentDirection;
-    uint8_t currentPosition;
-    uint8_t targetPosition;
+    int32_t positionFine;           // 0 .. POSITION_FINE_MAX
+    int32_t targetFine;
+    uint32_t positionRemainder;     // Divisionsrest der Integration (kein Drift durch Abrunden)
+    
+    // Fahrzeitmodell: Weg = Fahrweg-Integral des PWM-Ausgangs x Lastfaktor / Fahrzeit
+    uint64_t lastTravelUs;          // Stand von PWMController::getTravelUs() beim letzten Update
+    int32_t travelFine;             // Weg dieser Fahrt laut Modell (ohne Begrenzung auf 0..100%)
+    bool positionAtEndStop;         // Position stammt von einer erkannten Endlage
+    bool travelFromEndStop;         // Laufende Fahrt startete dort (Nachführung an der Gegenendlage)
+    
+    // Nachlauf-Messung: harter Stopp aus voller Fahrt nach einer Fahrt aus der Endlage.
+    // Die nächste Fahrt in eine Endlage zeigt, wie weit der Motor wirklich ausgelaufen ist.
+    MotorDirection inertiaProbeDir;     // Richtung des harten Stopps, DIR_STOP = keine Messung offen
+    int32_t inertiaProbeFine;           // Position nach dem Stopp (mit dem bisherigen Nachlauf)
+    uint32_t inertiaProbeScale;         // Lastfaktor beim Stopp
+    
+    float loadRef_mA[2];            // Laststrom der gelernten Fahrzeit (Öffnen/Schließen, 0 = unbekannt)
+    float load_mA[2];               // Gefilterter Laststrom je Richtung (über Fahrten hinweg)
+    float loadSum;                  // Mittelwert der laufenden Fahrt
+    uint32_t loadCount;
+    bool loadMeasured;              // Last dieser Fahrt bekannt (KINEMATIC_LOAD_SAMPLES erreicht)
+    unsigned long fullPwmSince;     // Ab hier volle PWM (Laststrom erst danach eingeschwungen)
+    uint32_t loadScale;             // Q16: Geschwindigkeit relativ zur Referenzlast
     
     unsigned long openTime;
     unsigned long closeTime;
@@ -41,23 +94,88 @@ private:
     unsigned long lastCurrentCheck;
     unsigned long overcurrentStartTime;
     
+    // Vorausberechneter Stopp: esp_timer schaltet die Enable-Pins unabhängig vom Hauptloop ab
+    esp_timer_handle_t stopTimer;
+    bool stopTimerArmed;
+    volatile bool stopTimerFired;
+    bool stopTimerHardPhase;        // Sanftstopp nicht möglich: Timer läuft bis zum Abschaltpunkt weiter
+    uint16_t stopInertiaMs;         // Nachlauf nach dem Abschalten (Fahrzeit-Äquivalent bei voller Geschwindigkeit)
+    uint32_t stopTimerScale;        // Lastfaktor beim Planen
+    bool stopTimerRampPlanned;      // Während des Sanftanlaufs geplant (Rampe vorausgerechnet)
+    bool stopTimerInertia;          // Abschaltpunkt um den Nachlauf vorgezogen, bei voller Fahrt
+    
+    // Arbitrierung: Befehl gegen die laufende Gegenrichtung bleibt vorgemerkt
+    // (ein Platz pro Motor, neuere Befehle ersetzen ältere)
+    MotorDirection pendingDirection;    // DIR_STOP = nichts vorgemerkt
+    int32_t pendingTargetFine;
+    unsigned long pendingDeadline;      // Danach starten keine neuen Fahrten der laufenden Richtung mehr
+    
     bool isCalibrated;
     bool overcurrentDetected;
-    float currentCurrent_mA;
+    float currentCurrent_mA;        // Gefiltert (gleitender Mittelwert der Sampler-Werte)
+    
+    EndStopDetector endStop;
+    bool endStopDetected;           // Vom Detektor gemeldet, Auswertung im Loop
+    unsigned long endStopOverrunStart;  // Schätzung hat die Endlage erreicht, Motor sucht sie noch
+    
+    CalibrationPhase calPhase;
+    uint8_t calRuns;
+    uint8_t calRunsDone;
+    uint32_t calOpenSum, calCloseSum;
+    uint32_t calOpenMin, calOpenMax;
+    uint32_t calCloseMin, calCloseMax;
+    bool calStepDone;               // halt() gehört zur Kalibrierung (sonst Abbruch)
     
     Preferences prefs;
     
+    static int8_t schedulerTask;    // Scheduler-Task, der loop() aufruft (wake bei Fahrtbeginn)
+    static int8_t statusTask;       // Scheduler-Task für den Status (wake bei Zustandswechsel)
+    static void (*eventHandler)(MotorController* motor, MotorEvent event);
+    static MotorController* registry[MOTOR_REGISTRY_SIZE];
+    static uint8_t registryCount;
+    
     void updatePosition();
+    void halt();
+    void startMove(MotorDirection dir);
+    void armStopTimer();
+    void disarmStopTimer();
+    static void onStopTimer(void* arg);
+    unsigned long getTravelTime();
+    uint64_t remainingTravelUs();
+    uint32_t computeLoadScale();
+    void updateLoadScale();
+    void measureLoad();
+    void refineTravelModel();
+    void learnStopInertia(int32_t endPosition);
+    uint32_t estimateMoveTime(MotorDirection dir, int32_t target);
+    void queueCommand(MotorDirection dir);
+    static bool isHeldBack(uint8_t output, MotorDirection dir);
+    static void dispatchPending(uint8_t output);
     void applyMotorControl(MotorDirection dir);
     void checkCurrent();
+    void resetCurrentFilter();
+    bool seeksEndStop();
+    void handleEndStop();
+    unsigned long measureLearnTime();
+    void continueCalibration();
+    void advanceCalibration();
+    void finishCalibration();
+    void emitEvent(MotorEvent event) { if (eventHandler) eventHandler(this, event); }
     
 public:
     MotorController(uint8_t motorId, uint8_t rEN, uint8_t lEN, uint8_t inaAddr);
     
     void begin();
     void loop();
+    uint32_t msUntilNextUpdate();   // Für den Scheduler (UINT32_MAX = steht)
+    static void setSchedulerTask(int8_t task) { schedulerTask = task; }
+    static int8_t getSchedulerTask() { return schedulerTask; }
+    static void setStatusTask(int8_t task) { statusTask = task; }
+    static void setEventHandler(void (*handler)(MotorController* motor, MotorEvent event)) { eventHandler = handler; }
     
     void moveToPosition(uint8_t position);
+    MotorDirection directionTo(uint8_t position);   // DIR_STOP = schon dort
+    uint32_t estimateMoveTo(uint8_t position);      // Geschätzte Fahrzeit (ms)
     void open();
     void close();
     void stop();
@@ -67,56 +185,149 @@ public:
     void finishLearn();
     void cancelLearn();
     
-    uint8_t getPosition() { return currentPosition; }
+    // Beide Endlagen per Strom anfahren, Fahrzeiten über mehrere Läufe mitteln
+    bool startAutoCalibration(uint8_t runs = AUTO_CAL_RUNS);
+    bool isAutoCalibrating() { return calPhase != CAL_IDLE; }
+    
+    uint8_t getPosition() { return (positionFine + POSITION_FINE_SCALE / 2) / POSITION_FINE_SCALE; }
+    int32_t getPositionFine() { return positionFine; }
+    uint8_t getTargetPosition() { return (targetFine + POSITION_FINE_SCALE / 2) / POSITION_FINE_SCALE; }
+    uint8_t getId() { return id; }
     MotorState getState() { return state; }
     MotorDirection getDirection() { return currentDirection; }
+    const char* getStateName();
+    const char* getDirectionName();
     bool getCalibrated() { return isCalibrated; }
     unsigned long getOpenTime() { return openTime; }
     unsigned long getCloseTime() { return closeTime; }
+    uint16_t getStopInertia() { return stopInertiaMs; }
     bool isMoving() { return state != STOPPED; }
+    bool isQueued() { return pendingDirection != DIR_STOP; }
     float getCurrent() { return currentCurrent_mA; }
     bool hasOvercurrent() { return overcurrentDetected; }
     
-    void setPosition(uint8_t pos) { currentPosition = pos; }
+    void setPosition(uint8_t pos) {
+        positionFine = (int32_t)min(pos, (uint8_t)100) * POSITION_FINE_SCALE;
+        positionAtEndStop = false;
+        inertiaProbeDir = DIR_STOP;
+    }
+    float getLoadReference(MotorDirection dir) { return loadRef_mA[dir == DIR_OPEN ? 0 : 1]; }
     
     void saveConfig();
     void loadConfig();
     void resetConfig();
 };
 
+// Rampenform für Sanftanlauf und Sanftstopp (Tabellen mit RAMP_TABLE_SIZE Stützstellen)
+enum RampCurve {
+    RAMP_LINEAR,
+    RAMP_SCURVE,                            // smoothstep: ruckfreier Beginn und Übergang
+    RAMP_EXPONENTIAL,                       // schneller Anstieg, sanftes Einlaufen in den Endwert
+    RAMP_LEARNED,                           // pro Ausgang im NVS abgelegt (Standard: S-Kurve)
+    RAMP_CURVE_COUNT
+};
+
+// Ein PWM-Ausgang = ein RPWM/LPWM-Kanalpaar mit eigener Rampe
+struct PWMOutput {
+    uint8_t rChannel;
+    uint8_t lChannel;
+    uint8_t activeOpen;
+    uint8_t activeClose;
+    uint8_t pwm;
+    
+    // Rampe (Sanftanlauf oder Sanftstopp), fortgeschaltet vom Rampen-Timer
+    RampCurve curve;
+    uint8_t rampFrom;
+    uint8_t rampTo;
+    int64_t rampBeginUs;
+    uint32_t rampDurationUs;
+    bool softStartActive;
+    bool softStopActive;
+    volatile bool softStopDone;             // Sanftstopp auf 0 angekommen (bis motorStopped)
+    bool skipSoftStart;                     // resetSoftStart() vor Relais-Bereitschaft
+    volatile bool cut;                      // Stopp-Timer hat abgeschaltet (bis motorStopped)
+    
+    // Fahrweg-Integral: Geschwindigkeit des anliegenden Tastgrads über die Zeit,
+    // fortgeschrieben bei jedem Schreiben auf die LEDC-Kanäle
+    uint8_t appliedDuty;
+    int64_t appliedSinceUs;
+    uint64_t travelQ16;                     // Fahrzeit-Äquivalent bei voller PWM (µs, Q16)
+};
+
 class PWMController {
 private:
-    static uint8_t activeMotorsOpen;
-    static uint8_t activeMotorsClose;
-    static uint8_t currentPWM;
+    static PWMOutput outputs[PWM_OUTPUT_COUNT];
     
-    static bool softStartActive;
-    static unsigned long softStartBegin;
-    static unsigned long lastPWMUpdate;
+    static uint8_t rampTables[RAMP_CURVE_COUNT - 1][RAMP_TABLE_SIZE + 1];
+    static uint8_t learnedTables[PWM_OUTPUT_COUNT][RAMP_TABLE_SIZE + 1];
+    static esp_timer_handle_t rampTimer;
+    static bool rampTimerRunning;
+    static portMUX_TYPE rampMux;
+    static unsigned long lastRampStep;      // Nur ohne esp_timer (Schritte aus loop())
     
     static bool relayOn;
+    static bool relayReady;                 // Relais eingeschaltet UND Einschaltverzögerung abgelaufen
+    static unsigned long relayOnTime;
+    static unsigned long relayReadyTime;
     static unsigned long lastMotorStopTime;
     static bool relayShutdownPending;
     
-    static void updateSoftStart();
+    static void buildRampTables();
+    static void loadLearnedCurves();
+    static const uint8_t* getRampTable(uint8_t output);
+    static uint8_t rampDuty(uint8_t output, int64_t nowUs, bool* finished);
+    static void startRamp(uint8_t output, uint8_t from, uint8_t to, uint32_t durationMs);
+    static void stepRamps();
+    static void onRampTimer(void* arg);
+    static void startRampTimer();
+    static void stopRampTimer();
+    
+    static void startSoftStart(uint8_t output);
+    static void writeOutput(uint8_t output);
+    static void writeDuty(uint8_t output, uint8_t rDuty, uint8_t lDuty);
     static void updateRelayControl();
     
 public:
     static void begin();
     static void loop();
+    static uint32_t msUntilNextUpdate();    // Für den Scheduler (UINT32_MAX = nichts zu tun)
+    
+    static uint8_t outputForMotor(uint8_t motorId);
+    static void attachOutput(uint8_t output, uint8_t rPin, uint8_t lPin);
+    
+    static void motorStarted(uint8_t output, MotorDirection dir);
+    static void motorStopped(uint8_t output, MotorDirection dir);
     
-    static void motorStarted(MotorDirection dir);
-    static void motorStopped(MotorDirection dir);
+    static void setPWM(uint8_t output, MotorDirection dir, uint8_t pwm);
+    static void cutOutput(uint8_t output);
+    static uint8_t getCurrentPWM(uint8_t output) { return outputs[output].pwm; }
     
-    static void setPWM(MotorDirection dir, uint8_t pwm);
-    static uint8_t getCurrentPWM() { return currentPWM; }
+    static bool isSoftStartActive(uint8_t output) { return outputs[output].softStartActive; }
+    static void resetSoftStart(uint8_t output);
     
-    static bool isSoftStartActive() { return softStartActive; }
-    static void resetSoftStart();
+    // Sanftstopp: nur wenn der Motor den Ausgang allein nutzt (auch aus dem esp_timer-Task)
+    static bool startSoftStop(uint8_t output);
+    static bool isSoftStopActive(uint8_t output) { return outputs[output].softStopActive; }
+    static bool isSoftStopDone(uint8_t output) { return outputs[output].softStopDone; }
+    static uint32_t getSoftStopTravelMs(uint8_t output, uint8_t fromPwm);   // Weg des Sanftstopps als Fahrzeit bei voller PWM
     
-    static uint8_t getActiveMotorCount() { return activeMotorsOpen + activeMotorsClose; }
-    static bool hasConflict() { return (activeMotorsOpen > 0 && activeMotorsClose > 0); }
+    // Fahrzeitmodell: Geschwindigkeit (Q16, 65536 = volle PWM) nach Abzug der Haftreibung
+    static uint32_t dutySpeed(uint8_t pwm);
+    static uint64_t getTravelUs(uint8_t output);                    // Fahrweg-Integral seit Start (µs bei voller PWM)
+    static uint64_t predictTimeUs(uint8_t output, uint64_t travelUs);   // Zeit bis travelUs zurückgelegt (0 = steht)
+    
+    static void setRampCurve(uint8_t output, RampCurve curve);
+    static RampCurve getRampCurve(uint8_t output) { return outputs[output].curve; }
+    static void setLearnedCurve(uint8_t output, const uint8_t* table);   // RAMP_TABLE_SIZE + 1 Werte, 0..255
+    
+    static uint8_t getActiveMotorCount();
+    static uint8_t getMotorCount(uint8_t output) { return outputs[output].activeOpen + outputs[output].activeClose; }
+    static bool hasConflict(uint8_t output, MotorDirection dir);   // Andere Richtung auf diesem Ausgang aktiv
     static bool isRelayOn() { return relayOn; }
+    
+    // Motorbefehle sind bis zur Relais-Bereitschaft vorgemerkt (kein Strom, PWM = 0)
+    static bool isRelayReady() { return relayReady; }
+    static unsigned long getRelayReadyTime() { return relayReadyTime; }
 };
 
 #endif
@@ -1,103 +1,515 @@
 #include "mqtt_handler.h"
-#include "config.h"
+#include "scheduler.h"
 #include <ArduinoJson.h>
 
 MQTTHandler* MQTTHandler::instance = nullptr;
 
+// Topic-Endungen hinter "<prefix>/", Reihenfolge = MqttTopicId
+static const char* const TOPIC_SUFFIXES[TOPIC_COUNT] = {
+    "motor1/set",
+    "motor2/set",
+    "motor3/set",
+    "motor4/set",
+    "all/set",
+    "motor1/learn",
+    "motor2/learn",
+    "motor3/learn",
+    "motor4/learn",
+    "all/learn",
+    "batch/set"
+};
+
 MQTTHandler::MQTTHandler() : mqttClient(wifiClient) {
     instance = this;
-    lastReconnectAttempt = 0;
+    taskHandle = nullptr;
+    backoffMs = MQTT_RECONNECT_MIN_MS;
+    outbox = nullptr;
+    connected = false;
+    connectGeneration = 0;
+    statusGeneration = 0;
+    for (uint8_t i = 0; i < MQTT_MOTOR_COUNT; i++) {
+        lastStatusValid[i] = false;
+        lastStatusAt[i] = 0;
+    }
+    lastSystemValid = false;
+    lastSystemAt = 0;
+    eventHead = 0;
+    eventCount = 0;
+    eventsDropped = 0;
+#if MQTT_EVENT_PERSIST
+    eventsPersisted = false;
+    eventsDirty = false;
+    eventsSavedAt = 0;
+#endif
+    
+    for (uint8_t i = 0; i < TOPIC_COUNT; i++) {
+        snprintf(subscribeTopics[i], MQTT_TOPIC_MAX, "%s/%s", TOPIC_PREFIX, TOPIC_SUFFIXES[i]);
+    }
+    for (uint8_t i = 0; i < MQTT_MOTOR_COUNT; i++) {
+        snprintf(stateTopics[i], MQTT_TOPIC_MAX, "%s/motor%d/state", TOPIC_PREFIX, i + 1);
+    }
+    snprintf(statusTopic, MQTT_TOPIC_MAX, "%s/status", TOPIC_PREFIX);
+    snprintf(systemTopic, MQTT_TOPIC_MAX, "%s/system", TOPIC_PREFIX);
+    snprintf(eventsTopic, MQTT_TOPIC_MAX, "%s/events", TOPIC_PREFIX);
 }
 
 void MQTTHandler::begin() {
+#if HA_DISCOVERY_ENABLED
+    buildDiscovery();
+#endif
+    
+#if MQTT_EVENT_PERSIST
+    loadEvents();
+#endif
+    
+    outbox = xQueueCreate(MQTT_OUTBOX_QUEUE_SIZE, sizeof(MqttMessage));
+    
     mqttClient.setServer(MQTT_SERVER, MQTT_PORT);
+    // Größte Nachricht: ausgehend Ereignis-Batch, eingehend velux/batch/set
+    mqttClient.setBufferSize(MQTT_TOPIC_MAX + max(MQTT_PAYLOAD_MAX, BATCH_JSON_MAX) + 16);
     mqttClient.setCallback([](char* topic, byte* payload, unsigned int length) {
         if (instance) {
             instance->callback(topic, payload, length);
         }
     });
     
+    // Verbindungsaufbau blockiert bis zum TCP-Timeout - daher eigener Task
+    // auf Core 0 (Core 1 = Arduino loop mit Motoren und Tasten)
+    xTaskCreatePinnedToCore(
+        mqttTask,             // Task-Funktion
+        "MqttTask",           // Name
+        6144,                 // Stack-Größe (TLS-frei, JSON auf dem Stack)
+        this,                 // Parameter
+        1,                    // Priorität (unter Strommessung und Keypad)
+        &taskHandle,          // Task-Handle
+        0                     // Core 0
+    );
+    
     Serial.println("MQTT: Initialisiert");
 }
 
-void MQTTHandler::loop() {
-    if (!mqttClient.connected()) {
-        unsigned long now = millis();
-        if (now - lastReconnectAttempt > 5000) {
-            lastReconnectAttempt = now;
-            reconnect();
+void MQTTHandler::mqttTask(void* parameter) {
+    static_cast<MQTTHandler*>(parameter)->connectionLoop();
+}
+
+void MQTTHandler::connectionLoop() {
+    for (;;) {
+        if (!mqttClient.connected()) {
+            if (connected) {
+                connected = false;
+                Serial.println("MQTT: Verbindung verloren");
+            }
+            
+            if (!reconnect()) {
+                // Exponentielles Backoff mit Jitter: Wartezeit zufällig in [b/2, b]
+                uint32_t wait = backoffMs / 2 + random(backoffMs / 2 + 1);
+                Serial.printf("MQTT: Nächster Versuch in %lums\n", (unsigned long)wait);
+                backoffMs = min(backoffMs * 2, (uint32_t)MQTT_RECONNECT_MAX_MS);
+                vTaskDelay(pdMS_TO_TICKS(wait));
+                continue;
+            }
+            backoffMs = MQTT_RECONNECT_MIN_MS;
         }
-    } else {
+        
         mqttClient.loop();
+        flushOutbox();
+        
+        // Neue Nachricht in der Outbox weckt sofort, sonst Empfang pollen
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MQTT_POLL_INTERVAL_MS));
     }
 }
 
-void MQTTHandler::reconnect() {
-    if (WiFi.status() != WL_CONNECTED) return;
+bool MQTTHandler::reconnect() {
+    if (WiFi.status() != WL_CONNECTED) return false;
     
     Serial.print("MQTT: Verbinde...");
     
-    String clientId = String(HOSTNAME) + "-" + String(random(0xffff), HEX);
+    char clientId[32];
+    snprintf(clientId, sizeof(clientId), "%s-%04lx", HOSTNAME, (unsigned long)random(0xffff));
     
-    if (mqttClient.connect(clientId.c_str(), MQTT_USER, MQTT_PASSWORD)) {
-        Serial.println(" verbunden!");
-        
-        // Subscribe zu allen Motor-Topics
-        mqttClient.subscribe((String(MQTT_TOPIC_PREFIX) + "/motor1/set").c_str());
-        mqttClient.subscribe((String(MQTT_TOPIC_PREFIX) + "/motor2/set").c_str());
-        mqttClient.subscribe((String(MQTT_TOPIC_PREFIX) + "/motor3/set").c_str());
-        mqttClient.subscribe((String(MQTT_TOPIC_PREFIX) + "/motor4/set").c_str());
-        mqttClient.subscribe((String(MQTT_TOPIC_PREFIX) + "/all/set").c_str());
+    // Last Will: Broker setzt velux/status auf "offline", wenn die Verbindung abreißt
+    if (!mqttClient.connect(clientId, MQTT_USER, MQTT_PASSWORD, statusTopic, 0, true, "offline")) {
+        Serial.printf(" fehlgeschlagen (rc=%d)\n", mqttClient.state());
+        return false;
+    }
+    
+    Serial.println(" verbunden!");
+    
+    // Subscribe zu allen Motor-Topics
+    for (uint8_t i = 0; i < TOPIC_COUNT; i++) {
+        mqttClient.subscribe(subscribeTopics[i]);
+    }
+    
+    // Online Status
+    mqttClient.publish(statusTopic, "online", true);
+    
+#if HA_DISCOVERY_ENABLED
+    publishDiscovery();
+#endif
+    
+    // Status aller Motoren sofort neu senden (Hauptloop vergleicht die Generation)
+    connected = true;
+    __atomic_fetch_add(&connectGeneration, 1, __ATOMIC_RELEASE);
+    Scheduler::wake(statusTask);
+    return true;
+}
+
+void MQTTHandler::flushOutbox() {
+    MqttMessage message;
+    while (mqttClient.connected() && xQueueReceive(outbox, &message, 0) == pdTRUE) {
+        mqttClient.publish(message.topic, message.payload, message.retain);
+    }
+}
+
+#if HA_DISCOVERY_ENABLED
+void MQTTHandler::buildDiscovery() {
+    // Eindeutig pro Gerät (mehrere Controller am selben Broker)
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    snprintf(deviceId, sizeof(deviceId), "velux_%02x%02x%02x", mac[3], mac[4], mac[5]);
+    
+    for (uint8_t i = 0; i < MQTT_MOTOR_COUNT; i++) {
+        uint8_t n = i + 1;
+        snprintf(discoveryTopics[i], MQTT_DISCOVERY_TOPIC_MAX, "%s/cover/%s/motor%d/config",
+                 HA_DISCOVERY_PREFIX, deviceId, n);
         
-        // Online Status
-        publish("status", "online");
+        // Abgekürzte Schlüssel der HA-Discovery, "~" = Basis-Topic des Motors
+        int len = snprintf(discoveryPayloads[i], MQTT_DISCOVERY_MAX,
+            "{\"~\":\"%s/motor%d\","
+            "\"name\":\"%s %d\","
+            "\"uniq_id\":\"%s_motor%d\","
+            "\"dev_cla\":\"shutter\","
+            "\"cmd_t\":\"~/set\","
+            "\"pl_open\":\"OPEN\",\"pl_cls\":\"CLOSE\",\"pl_stop\":\"STOP\","
+            "\"set_pos_t\":\"~/set\","
+            "\"pos_t\":\"~/state\",\"pos_tpl\":\"{{ value_json.position }}\","
+            "\"stat_t\":\"~/state\","
+            "\"val_tpl\":\"{{ {'open':'opening','close':'closing'}.get(value_json.direction, 'stopped') }}\","
+            "\"avty_t\":\"%s\",\"pl_avail\":\"online\",\"pl_not_avail\":\"offline\","
+            "\"dev\":{\"ids\":[\"%s\"],\"name\":\"%s\",\"mdl\":\"ESP32 + BTS7960\",\"mf\":\"DIY\"}}",
+            TOPIC_PREFIX, n,
+            HA_COVER_NAME, n,
+            deviceId, n,
+            statusTopic,
+            deviceId, HA_DEVICE_NAME);
         
-    } else {
-        Serial.printf(" fehlgeschlagen (rc=%d)\n", mqttClient.state());
+        if (len >= MQTT_DISCOVERY_MAX) {
+            Serial.printf("MQTT: Discovery Motor %d abgeschnitten (%d Bytes)\n", n, len);
+            discoveryPayloads[i][0] = '\0';
+        }
+    }
+    
+    Serial.printf("MQTT: Home Assistant Discovery als %s\n", deviceId);
+}
+
+void MQTTHandler::publishDiscovery() {
+    // Stückweise senden: die Konfiguration ist größer als der PubSubClient-Puffer
+    for (uint8_t i = 0; i < MQTT_MOTOR_COUNT; i++) {
+        size_t len = strlen(discoveryPayloads[i]);
+        if (len == 0) continue;
+        if (!mqttClient.beginPublish(discoveryTopics[i], len, true)) continue;
+        mqttClient.write((const uint8_t*)discoveryPayloads[i], len);
+        mqttClient.endPublish();
+    }
+}
+#endif
+
+MqttTopicId MQTTHandler::routeTopic(const char* topic) {
+    if (strncmp(topic, TOPIC_PREFIX, TOPIC_PREFIX_LEN) != 0 || topic[TOPIC_PREFIX_LEN] != '/') {
+        return TOPIC_UNKNOWN;
     }
+    const char* suffix = topic + TOPIC_PREFIX_LEN + 1;
+    for (uint8_t i = 0; i < TOPIC_COUNT; i++) {
+        if (strcmp(suffix, TOPIC_SUFFIXES[i]) == 0) return (MqttTopicId)i;
+    }
+    return TOPIC_UNKNOWN;
 }
 
 void MQTTHandler::callback(char* topic, byte* payload, unsigned int length) {
-    char message[length + 1];
-    memcpy(message, payload, length);
-    message[length] = '\0';
+    // Läuft im MQTT-Task: nur routen, die Callbacks posten in die CommandQueue
+    MqttTopicId id = routeTopic(topic);
+    
+    // Batch passt nicht in einen Einzelbefehl: hier parsen, als Ganzes weiterreichen
+    if (id == TOPIC_BATCH_SET) {
+        CommandBatch batch;
+        const char* error = nullptr;
+        if (length > BATCH_JSON_MAX) {
+            Serial.println("MQTT: Batch zu groß");
+        } else if (!parseCommandBatch((const char*)payload, length, batch, &error)) {
+            Serial.printf("MQTT: Batch ungültig (%s)\n", error);
+        } else if (onBatch) {
+            onBatch(batch);
+        }
+        return;
+    }
+    char message[COMMAND_ARG_MAX];
+    unsigned int n = min(length, (unsigned int)(sizeof(message) - 1));
+    memcpy(message, payload, n);
+    message[n] = '\0';
     
     Serial.printf("MQTT: %s = %s\n", topic, message);
     
-    String topicStr = String(topic);
-    String prefix = String(MQTT_TOPIC_PREFIX);
+    if (id == TOPIC_UNKNOWN) return;
+    dispatch(id, message);
+}
+
+void MQTTHandler::dispatch(MqttTopicId topic, const char* message) {
+    switch (topic) {
+        case TOPIC_MOTOR1_SET:   if (onMotor1Command) onMotor1Command(message); break;
+        case TOPIC_MOTOR2_SET:   if (onMotor2Command) onMotor2Command(message); break;
+        case TOPIC_MOTOR3_SET:   if (onMotor3Command) onMotor3Command(message); break;
+        case TOPIC_MOTOR4_SET:   if (onMotor4Command) onMotor4Command(message); break;
+        case TOPIC_ALL_SET:      if (onAllCommand) onAllCommand(message); break;
+        case TOPIC_MOTOR1_LEARN: if (onMotor1Learn) onMotor1Learn(message); break;
+        case TOPIC_MOTOR2_LEARN: if (onMotor2Learn) onMotor2Learn(message); break;
+        case TOPIC_MOTOR3_LEARN: if (onMotor3Learn) onMotor3Learn(message); break;
+        case TOPIC_MOTOR4_LEARN: if (onMotor4Learn) onMotor4Learn(message); break;
+        case TOPIC_ALL_LEARN:    if (onAllLearn) onAllLearn(message); break;
+        default: break;
+    }
+}
+
+bool MQTTHandler::publishFull(const char* fullTopic, const char* payload, bool retain) {
+    // Nur über die Outbox: den Socket bedient ausschließlich der MQTT-Task
+    if (!connected || !outbox) return false;
+    
+    MqttMessage message;
+    strlcpy(message.topic, fullTopic, sizeof(message.topic));
+    strlcpy(message.payload, payload, sizeof(message.payload));
+    message.retain = retain;
+    if (xQueueSend(outbox, &message, 0) != pdTRUE) return false;
+    
+    xTaskNotifyGive(taskHandle);
+    return true;
+}
+
+bool MQTTHandler::publish(const char* topic, const char* payload) {
+    char fullTopic[MQTT_TOPIC_MAX];
+    snprintf(fullTopic, sizeof(fullTopic), "%s/%s", TOPIC_PREFIX, topic);
+    return publishFull(fullTopic, payload);
+}
+
+bool MQTTHandler::publishMotorState(uint8_t motorId, const MotorStatus& status) {
+    if (motorId < 1 || motorId > MQTT_MOTOR_COUNT) return false;
+    if (!connected) return false;
+    
+    StaticJsonDocument<200> doc;
+    doc["state"] = status.state;
+    doc["direction"] = status.direction;
+    doc["position"] = status.position;
+    doc["target"] = status.target;
+    doc["current"] = (int)(status.current + 0.5f);
     
-    if (topicStr == prefix + "/motor1/set" && onMotor1Command) {
-        onMotor1Command(message);
-    } else if (topicStr == prefix + "/motor2/set" && onMotor2Command) {
-        onMotor2Command(message);
-    } else if (topicStr == prefix + "/motor3/set" && onMotor3Command) {
-        onMotor3Command(message);
-    } else if (topicStr == prefix + "/motor4/set" && onMotor4Command) {
-        onMotor4Command(message);
-    } else if (topicStr == prefix + "/all/set" && onAllCommand) {
-        onAllCommand(message);
+    char output[MQTT_PAYLOAD_MAX];
+    serializeJson(doc, output, sizeof(output));
+    
+    return publishFull(stateTopics[motorId - 1], output);
+}
+
+// Nach jedem Verbindungsaufbau gilt kein Status mehr als gesendet
+void MQTTHandler::syncGeneration() {
+    uint32_t generation = __atomic_load_n(&connectGeneration, __ATOMIC_ACQUIRE);
+    if (generation == statusGeneration) return;
+    
+    statusGeneration = generation;
+    for (uint8_t i = 0; i < MQTT_MOTOR_COUNT; i++) {
+        lastStatusValid[i] = false;
     }
+    lastSystemValid = false;
 }
 
-void MQTTHandler::publish(const char* topic, const char* payload) {
-    if (!mqttClient.connected()) return;
+bool MQTTHandler::updateMotorState(uint8_t motorId, const MotorStatus& status, bool moving) {
+    if (motorId < 1 || motorId > MQTT_MOTOR_COUNT) return false;
+    if (!connected) return false;
+    syncGeneration();
+    
+    uint8_t i = motorId - 1;
+    const MotorStatus& last = lastStatus[i];
+    unsigned long now = millis();
+    unsigned long since = now - lastStatusAt[i];
+    
+    bool transition = !lastStatusValid[i] ||
+                      strcmp(status.state, last.state) != 0 ||
+                      strcmp(status.direction, last.direction) != 0 ||
+                      status.target != last.target;
+    bool changed = status.position != last.position ||
+                   fabsf(status.current - last.current) >= STATUS_CURRENT_DELTA_MA;
+    
+    bool due;
+    if (transition) {
+        due = true;                                     // Zustandswechsel sofort
+    } else if (changed) {
+        due = !moving || since >= STATUS_MOVING_INTERVAL_MS;
+    } else {
+        due = since >= STATUS_HEARTBEAT_MS;             // Heartbeat
+    }
+    if (!due) return false;
     
-    String fullTopic = String(MQTT_TOPIC_PREFIX) + "/" + String(topic);
-    mqttClient.publish(fullTopic.c_str(), payload, true);
+    if (!publishMotorState(motorId, status)) return false;
+    
+    lastStatus[i] = status;
+    lastStatusAt[i] = now;
+    lastStatusValid[i] = true;
+    return true;
 }
 
-void MQTTHandler::publishMotorState(uint8_t motorId, const char* state, uint8_t position, float current) {
-    if (!mqttClient.connected()) return;
+bool MQTTHandler::updateSystemState(const SystemStatus& status) {
+    if (!connected) return false;
+    syncGeneration();
+    
+    unsigned long now = millis();
+    if (lastSystemValid && now - lastSystemAt < STATUS_HEARTBEAT_MS) return false;
     
     StaticJsonDocument<200> doc;
-    doc["state"] = state;
-    doc["position"] = position;
-    doc["current"] = current;
+    doc["heap_free"] = status.heapFree;
+    doc["heap_min_free"] = status.heapMinFree;
+    doc["heap_max_block"] = status.heapMaxBlock;
+    doc["heap_fragmentation"] = status.heapFragmentation;
+    doc["uptime"] = status.uptime;
+    
+    char output[MQTT_PAYLOAD_MAX];
+    serializeJson(doc, output, sizeof(output));
+    
+    if (!publishFull(systemTopic, output)) return false;
+    
+    lastSystemAt = now;
+    lastSystemValid = true;
+    return true;
+}
+
+// ===== Ereignisprotokoll =====
+
+static const char* const EVENT_NAMES[] = { "open", "close", "stop", "overcurrent" };
+
+void MQTTHandler::logEvent(uint8_t motorId, MqttEventType type, uint8_t position) {
+    if (eventCount == MQTT_EVENT_RING_SIZE) {
+        // Voll: ältestes Ereignis verwerfen, der Zähler geht mit dem nächsten Batch raus
+        eventHead = (eventHead + 1) % MQTT_EVENT_RING_SIZE;
+        eventCount--;
+        eventsDropped++;
+    }
+    
+    MqttEvent& event = events[(eventHead + eventCount) % MQTT_EVENT_RING_SIZE];
+    event.timeMs = millis();
+    event.motorId = motorId;
+    event.type = type;
+    event.position = position;
+    event.flags = 0;
+    eventCount++;
+    
+#if MQTT_EVENT_PERSIST
+    // Nur bei Ausfall, und gedrosselt (Tastatur im Dauerbetrieb würde den Flash abnutzen)
+    if (!connected) {
+        eventsDirty = true;
+        persistEvents();
+    }
+#endif
+    Scheduler::wake(statusTask);
+}
+
+bool MQTTHandler::flushEvents() {
+    if (!connected) {
+#if MQTT_EVENT_PERSIST
+        // Zurückgehaltene Ereignisse nachschreiben (Status-Task läuft mit offenen Ereignissen weiter)
+        persistEvents();
+#endif
+        return eventCount == 0;
+    }
+    
+    unsigned long now = millis();
+    while (eventCount > 0) {
+        StaticJsonDocument<512> doc;
+        JsonArray list = doc.createNestedArray("events");
+        uint8_t n = min(eventCount, (uint8_t)MQTT_EVENT_BATCH);
+        for (uint8_t k = 0; k < n; k++) {
+            const MqttEvent& event = events[(eventHead + k) % MQTT_EVENT_RING_SIZE];
+            JsonObject entry = list.createNestedObject();
+            entry["motor"] = event.motorId;
+            entry["event"] = EVENT_NAMES[event.type];
+            entry["position"] = event.position;
+            if (event.flags & MQTT_EVENT_FLAG_PREV_BOOT) {
+                entry["prev_boot"] = true;
+            } else {
+                entry["age"] = now - event.timeMs;      // ms vor dem Senden
+            }
+        }
+        if (eventsDropped > 0) doc["dropped"] = eventsDropped;
+        
+        char output[MQTT_PAYLOAD_MAX];
+        serializeJson(doc, output, sizeof(output));
+        
+        // Outbox voll: Rest beim nächsten Durchlauf des Status-Tasks
+        if (!publishFull(eventsTopic, output, false)) return false;
+        
+        eventHead = (eventHead + n) % MQTT_EVENT_RING_SIZE;
+        eventCount -= n;
+        eventsDropped = 0;
+    }
+    
+#if MQTT_EVENT_PERSIST
+    if (eventsPersisted) saveEvents();
+#endif
+    return true;
+}
+
+#if MQTT_EVENT_PERSIST
+void MQTTHandler::persistEvents() {
+    if (!eventsDirty) return;
+    // Erstes Ereignis eines Ausfalls sofort, danach höchstens einmal pro Intervall
+    if (eventsPersisted && millis() - eventsSavedAt < MQTT_EVENT_PERSIST_INTERVAL_MS) return;
+    saveEvents();
+}
+
+void MQTTHandler::saveEvents() {
+    // Linear ab dem ältesten Ereignis ablegen
+    MqttEvent linear[MQTT_EVENT_RING_SIZE];
+    for (uint8_t k = 0; k < eventCount; k++) {
+        linear[k] = events[(eventHead + k) % MQTT_EVENT_RING_SIZE];
+    }
     
-    String output;
-    serializeJson(doc, output);
+    prefs.begin(PREFS_NAMESPACE, false);
+    if (eventCount > 0) {
+        prefs.putBytes("mq_events", linear, eventCount * sizeof(MqttEvent));
+    } else {
+        prefs.remove("mq_events");
+    }
+    prefs.end();
+    eventsPersisted = eventCount > 0;
+    eventsDirty = false;
+    eventsSavedAt = millis();
+}
+
+void MQTTHandler::loadEvents() {
+    prefs.begin(PREFS_NAMESPACE, true);
+    size_t len = prefs.getBytesLength("mq_events");
+    if (len > 0 && len <= sizeof(events) && len % sizeof(MqttEvent) == 0) {
+        prefs.getBytes("mq_events", events, len);
+        eventHead = 0;
+        eventCount = len / sizeof(MqttEvent);
+        for (uint8_t k = 0; k < eventCount; k++) {
+            events[k].flags |= MQTT_EVENT_FLAG_PREV_BOOT;
+        }
+        eventsPersisted = true;
+        Serial.printf("MQTT: %d Ereignisse aus dem NVS übernommen\n", eventCount);
+    }
+    prefs.end();
+}
+#endif
+
+// Restzeit bis zum nächsten Heartbeat (0 = Status steht noch aus)
+static uint32_t heartbeatLeft(bool valid, unsigned long since) {
+    if (!valid || since >= STATUS_HEARTBEAT_MS) return 0;
+    return STATUS_HEARTBEAT_MS - since;
+}
+
+uint32_t MQTTHandler::msUntilHeartbeat() {
+    if (!connected) return UINT32_MAX;
+    syncGeneration();
     
-    String topic = "motor" + String(motorId) + "/state";
-    publish(topic.c_str(), output.c_str());
+    unsigned long now = millis();
+    uint32_t wait = heartbeatLeft(lastSystemValid, now - lastSystemAt);
+    for (uint8_t i = 0; i < MQTT_MOTOR_COUNT; i++) {
+        wait = min(wait, heartbeatLeft(lastStatusValid[i], now - lastStatusAt[i]));
+    }
+    return wait;
 }
@@ -4,30 +4,178 @@
 #include <Arduino.h>
 #include <PubSubClient.h>
 #include <WiFi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <Preferences.h>
+#include "config.h"
+#include "command_batch.h"
+#include "command_queue.h"
+#include "status_snapshot.h"
+
+#define MQTT_MOTOR_COUNT 4
+#define MQTT_TOPIC_MAX 48               // Puffer für "<prefix>/motorN/learn" usw.
+#define MQTT_PAYLOAD_MAX 384            // Ausgehendes JSON (Status, Ereignis-Batch)
+#define MQTT_DISCOVERY_TOPIC_MAX 80     // "homeassistant/cover/<id>/motorN/config"
+#define MQTT_DISCOVERY_MAX 768          // Discovery-JSON pro Motor
+#define MQTT_OUTBOX_QUEUE_SIZE 12       // Hauptloop -> MQTT-Task
+#define MQTT_EVENT_RING_SIZE 32         // Ereignisse, die einen Broker-Ausfall überbrücken
+#define MQTT_EVENT_BATCH 4              // Ereignisse pro Nachricht auf velux/events
+
+// Abonnierte Topics, Index = Routing-ID
+enum MqttTopicId {
+    TOPIC_MOTOR1_SET,
+    TOPIC_MOTOR2_SET,
+    TOPIC_MOTOR3_SET,
+    TOPIC_MOTOR4_SET,
+    TOPIC_ALL_SET,
+    TOPIC_MOTOR1_LEARN,
+    TOPIC_MOTOR2_LEARN,
+    TOPIC_MOTOR3_LEARN,
+    TOPIC_MOTOR4_LEARN,
+    TOPIC_ALL_LEARN,
+    TOPIC_BATCH_SET,
+    TOPIC_COUNT,
+    TOPIC_UNKNOWN = -1
+};
+
+// Ausgehende Nachricht, vom Hauptloop an den MQTT-Task übergeben
+struct MqttMessage {
+    char topic[MQTT_TOPIC_MAX];
+    char payload[MQTT_PAYLOAD_MAX];
+    bool retain;
+};
+
+enum MqttEventType : uint8_t {
+    MQTT_EVENT_OPEN,                // Fahrt in Richtung Auf gestartet
+    MQTT_EVENT_CLOSE,
+    MQTT_EVENT_STOP,
+    MQTT_EVENT_OVERCURRENT
+};
+
+#define MQTT_EVENT_FLAG_PREV_BOOT 0x01  // Aus dem NVS, Zeitstempel vor dem letzten Neustart
+
+// Ereignis im Ringpuffer (feste Größe, wird so auch im NVS abgelegt)
+struct MqttEvent {
+    uint32_t timeMs;                // millis() beim Eintrag
+    uint8_t motorId;
+    uint8_t type;                   // MqttEventType
+    uint8_t position;               // %
+    uint8_t flags;
+};
+
+// Motorstatus für velux/motorN/state
+struct MotorStatus {
+    const char* state;              // "stopped", "opening", "closing", "stopping", ...
+    const char* direction;          // "open", "close", "stop"
+    uint8_t position;               // %
+    uint8_t target;                 // %
+    float current;                  // mA
+};
 
 class MQTTHandler {
 private:
+    static constexpr const char* TOPIC_PREFIX = MQTT_TOPIC_PREFIX;
+    static constexpr size_t TOPIC_PREFIX_LEN = sizeof(MQTT_TOPIC_PREFIX) - 1;
+    
+    // Verbindung, Socket und PubSubClient gehören allein dem MQTT-Task
     WiFiClient wifiClient;
     PubSubClient mqttClient;
-    unsigned long lastReconnectAttempt;
+    TaskHandle_t taskHandle;
+    uint32_t backoffMs;             // Aktuelle Wartezeit bis zum nächsten Verbindungsversuch
+    
+    QueueHandle_t outbox;           // MqttMessage: Hauptloop -> MQTT-Task
+    volatile bool connected;        // Vom MQTT-Task gepflegt
+    uint32_t connectGeneration;     // Zählt Verbindungsaufbauten (MQTT-Task)
+    uint32_t statusGeneration;      // Stand, auf den sich lastStatus bezieht (Hauptloop)
+    
+    // Vorberechnete Topics (einmal im Konstruktor, danach keine Heap-Allokation)
+    char subscribeTopics[TOPIC_COUNT][MQTT_TOPIC_MAX];
+    char stateTopics[MQTT_MOTOR_COUNT][MQTT_TOPIC_MAX];
+    char statusTopic[MQTT_TOPIC_MAX];
+    char systemTopic[MQTT_TOPIC_MAX];
+    
+#if HA_DISCOVERY_ENABLED
+    // Home Assistant Discovery: einmal in begin() gebaut, bei jedem Connect nur gesendet
+    char deviceId[24];
+    char discoveryTopics[MQTT_MOTOR_COUNT][MQTT_DISCOVERY_TOPIC_MAX];
+    char discoveryPayloads[MQTT_MOTOR_COUNT][MQTT_DISCOVERY_MAX];
+    void buildDiscovery();
+    void publishDiscovery();
+#endif
+    
+    // Zuletzt gesendeter Status pro Motor (Delta-Vergleich)
+    MotorStatus lastStatus[MQTT_MOTOR_COUNT];
+    unsigned long lastStatusAt[MQTT_MOTOR_COUNT];
+    bool lastStatusValid[MQTT_MOTOR_COUNT];
+    unsigned long lastSystemAt;
+    bool lastSystemValid;
     
-    void reconnect();
+    // Ereignisprotokoll (nur Hauptloop): überbrückt Broker-Ausfälle, Älteste fallen bei Überlauf heraus
+    MqttEvent events[MQTT_EVENT_RING_SIZE];
+    uint8_t eventHead;              // Index des ältesten Ereignisses
+    uint8_t eventCount;
+    uint16_t eventsDropped;         // Seit dem letzten Senden verlorene Ereignisse
+    char eventsTopic[MQTT_TOPIC_MAX];
+#if MQTT_EVENT_PERSIST
+    Preferences prefs;
+    bool eventsPersisted;           // NVS enthält noch nicht gesendete Ereignisse
+    bool eventsDirty;               // Ringpuffer neuer als das NVS
+    unsigned long eventsSavedAt;
+    void persistEvents();           // Gedrosselt: höchstens alle MQTT_EVENT_PERSIST_INTERVAL_MS
+    void saveEvents();
+    void loadEvents();
+#endif
+    
+    static void mqttTask(void* parameter);
+    void connectionLoop();
+    bool reconnect();
+    void flushOutbox();
     void callback(char* topic, byte* payload, unsigned int length);
+    static MqttTopicId routeTopic(const char* topic);
+    void dispatch(MqttTopicId topic, const char* message);
+    bool publishFull(const char* fullTopic, const char* payload, bool retain = true);
+    void syncGeneration();
     static MQTTHandler* instance;
     
 public:
     MQTTHandler();
-    void begin();
-    void loop();
+    void begin();                   // Startet den MQTT-Task (Verbindung mit Backoff)
+    bool isConnected() { return connected; }
+    
+    int8_t statusTask = -1;         // Scheduler-Task für den Status (wake nach Verbindungsaufbau)
+    
+    bool publish(const char* topic, const char* payload);
+    bool publishMotorState(uint8_t motorId, const MotorStatus& status);
+    // Sendet nur bei Zustandswechsel, bei Änderung (während der Fahrt höchstens
+    // alle STATUS_MOVING_INTERVAL_MS) und als Heartbeat
+    bool updateMotorState(uint8_t motorId, const MotorStatus& status, bool moving);
+    bool updateSystemState(const SystemStatus& status);     // Im Heartbeat-Takt
+    
+    // Ereignisse mit Zeitstempel; ohne Verbindung im Ringpuffer, nach dem
+    // Verbindungsaufbau gebündelt auf velux/events nachgesendet
+    void logEvent(uint8_t motorId, MqttEventType type, uint8_t position);
+    bool flushEvents();             // false = es bleiben Ereignisse übrig
+    bool hasPendingEvents() { return eventCount > 0; }
+    uint32_t msUntilHeartbeat();    // UINT32_MAX = nicht verbunden
+    
+    // Befehls-Callbacks laufen im MQTT-Task: nur in die CommandQueue posten,
+    // nie direkt auf Motoren zugreifen. false = nicht angenommen (Queue voll)
+    bool (*onMotor1Command)(const char* cmd) = nullptr;
+    bool (*onMotor2Command)(const char* cmd) = nullptr;
+    bool (*onMotor3Command)(const char* cmd) = nullptr;
+    bool (*onMotor4Command)(const char* cmd) = nullptr;
+    bool (*onAllCommand)(const char* cmd) = nullptr;
     
-    void publish(const char* topic, const char* payload);
-    void publishMotorState(uint8_t motorId, const char* state, uint8_t position, float current);
+    // Anlernen: "open", "close", "finish", "cancel", "auto"
+    bool (*onMotor1Learn)(const char* type) = nullptr;
+    bool (*onMotor2Learn)(const char* type) = nullptr;
+    bool (*onMotor3Learn)(const char* type) = nullptr;
+    bool (*onMotor4Learn)(const char* type) = nullptr;
+    bool (*onAllLearn)(const char* type) = nullptr;
     
-    void (*onMotor1Command)(const char* cmd) = nullptr;
-    void (*onMotor2Command)(const char* cmd) = nullptr;
-    void (*onMotor3Command)(const char* cmd) = nullptr;
-    void (*onMotor4Command)(const char* cmd) = nullptr;
-    void (*onAllCommand)(const char* cmd) = nullptr;
+    // velux/batch/set: JSON-Array wie POST /api/batch
+    bool (*onBatch)(const CommandBatch& batch) = nullptr;
 };
 
 #endif
@@ -0,0 +1,76 @@
+#include "scheduler.h"
+#include "config.h"
+
+Scheduler::Task Scheduler::tasks[SCHEDULER_MAX_TASKS];
+uint8_t Scheduler::taskCount = 0;
+uint32_t Scheduler::pendingMask = 0;
+TaskHandle_t Scheduler::loopTask = nullptr;
+uint32_t Scheduler::wakeups = 0;
+uint32_t Scheduler::sleepMs = 0;
+
+void Scheduler::begin() {
+    loopTask = xTaskGetCurrentTaskHandle();
+    Serial.println("Scheduler: Initialisiert (Deadline-basiert, kein delay im Hauptloop)");
+}
+
+int8_t Scheduler::add(const char* name, SchedulerTaskFn fn) {
+    if (taskCount >= SCHEDULER_MAX_TASKS) {
+        Serial.printf("Scheduler: Kein Platz für Task '%s'!\n", name);
+        return -1;
+    }
+    
+    tasks[taskCount].name = name;
+    tasks[taskCount].fn = fn;
+    tasks[taskCount].deadline = millis();   // Erster Aufruf sofort
+    
+    Serial.printf("Scheduler: Task '%s' registriert\n", name);
+    return taskCount++;
+}
+
+void Scheduler::wake(int8_t id) {
+    if (id < 0) return;
+    __atomic_fetch_or(&pendingMask, 1UL << id, __ATOMIC_RELEASE);
+    if (loopTask) xTaskNotifyGive(loopTask);
+}
+
+void Scheduler::wakeFromISR(int8_t id) {
+    if (id < 0) return;
+    __atomic_fetch_or(&pendingMask, 1UL << id, __ATOMIC_RELEASE);
+    if (loopTask) {
+        BaseType_t higherPrioWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(loopTask, &higherPrioWoken);
+        if (higherPrioWoken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+void Scheduler::run() {
+    uint32_t pending = __atomic_exchange_n(&pendingMask, 0, __ATOMIC_ACQUIRE);
+    uint32_t now = millis();
+    
+    for (uint8_t i = 0; i < taskCount; i++) {
+        Task& t = tasks[i];
+        bool due = (int32_t)(now - t.deadline) >= 0;
+        
+        if (due || (pending & (1UL << i))) {
+            uint32_t wait = t.fn(now);
+            if (wait > SCHEDULER_MAX_SLEEP_MS) wait = SCHEDULER_MAX_SLEEP_MS;
+            now = millis();
+            t.deadline = now + wait;
+        }
+    }
+    
+    // Nächste Deadline bestimmen
+    uint32_t sleep = SCHEDULER_MAX_SLEEP_MS;
+    for (uint8_t i = 0; i < taskCount; i++) {
+        int32_t remaining = (int32_t)(tasks[i].deadline - now);
+        if (remaining <= 0) return;         // Schon wieder fällig - nicht schlafen
+        if ((uint32_t)remaining < sleep) sleep = remaining;
+    }
+    
+    // Schlafen bis Deadline oder Ereignis (wake)
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleep));
+    sleepMs += millis() - now;
+    wakeups++;
+}
@@ -0,0 +1,48 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define SCHEDULER_MAX_TASKS 8
+
+// Task-Funktion: erledigt ihre Arbeit und gibt zurück, in wie vielen ms sie
+// wieder aufgerufen werden will (UINT32_MAX = nur bei wake()).
+typedef uint32_t (*SchedulerTaskFn)(uint32_t now);
+
+// Kooperativer Scheduler für den Hauptloop (Core 1).
+// Statt delay(10) schläft loop() bis zur nächsten Deadline oder bis ein
+// anderer Task/ISR per wake() ein Ereignis meldet (Task-Notification).
+class Scheduler {
+private:
+    struct Task {
+        const char* name;
+        SchedulerTaskFn fn;
+        uint32_t deadline;
+    };
+    
+    static Task tasks[SCHEDULER_MAX_TASKS];
+    static uint8_t taskCount;
+    static uint32_t pendingMask;        // Per wake() fällig gemachte Tasks (atomar)
+    static TaskHandle_t loopTask;
+    
+    static uint32_t wakeups;
+    static uint32_t sleepMs;
+    
+public:
+    static void begin();                // Aus setup() aufrufen (merkt sich den Loop-Task)
+    static int8_t add(const char* name, SchedulerTaskFn fn);
+    
+    // Task sofort fällig machen - aus beliebigem Task (AsyncTCP, Core 0) oder ISR
+    static void wake(int8_t id);
+    static void wakeFromISR(int8_t id);
+    
+    // Ein Durchlauf: fällige Tasks ausführen, dann bis zur nächsten Deadline schlafen
+    static void run();
+    
+    static uint32_t getWakeups() { return wakeups; }
+    static uint32_t getSleepMs() { return sleepMs; }
+};
+
+#endif
@@ -0,0 +1,564 @@
+#include "hal_sim.h"
+#include <Preferences.h>
+#include <Adafruit_INA219.h>
+#include <Wire.h>
+#include <RCSwitch.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <esp_timer.h>
+#include <cstdarg>
+#include <cstdio>
+#include <cctype>
+#include <deque>
+#include <map>
+#include <vector>
+
+// ===== Simulationszustand =====
+
+#define SIM_NUM_PINS 40
+#define SIM_NUM_LEDC_CHANNELS 16
+#define SIM_MAX_TICK_HOOKS 8
+
+static uint32_t simMillis = 0;
+static uint8_t pinLevels[SIM_NUM_PINS];
+static int8_t pinChannel[SIM_NUM_PINS];
+static uint32_t channelDuty[SIM_NUM_LEDC_CHANNELS];
+static uint16_t analogValue[SIM_NUM_PINS];
+static uint16_t analogNoise[SIM_NUM_PINS];
+static bool pinChannelInit = false;
+
+static void fireTimers();
+
+static sim::TickHook tickHooks[SIM_MAX_TICK_HOOKS];
+static int tickHookCount = 0;
+static bool inTick = false;
+
+static sim::CurrentSource currentSource = nullptr;
+static std::deque<unsigned long> rfCodes;
+static bool logEnabled = true;
+static uint32_t rngState = 0x12345678;
+
+HardwareSerial Serial;
+TwoWire Wire;
+
+static void initPinChannels() {
+    if (pinChannelInit) return;
+    for (int i = 0; i < SIM_NUM_PINS; i++) pinChannel[i] = -1;
+    pinChannelInit = true;
+}
+
+namespace sim {
+
+uint32_t now() {
+    return simMillis;
+}
+
+void advance(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i++) {
+        simMillis++;
+        // Hooks dürfen selbst delay() aufrufen (z.B. Task-Code) - nicht rekursiv ticken
+        if (inTick) continue;
+        inTick = true;
+        fireTimers();
+        for (int h = 0; h < tickHookCount; h++) {
+            tickHooks[h](simMillis);
+        }
+        inTick = false;
+    }
+}
+
+void addTickHook(TickHook hook) {
+    if (tickHookCount < SIM_MAX_TICK_HOOKS) {
+        tickHooks[tickHookCount++] = hook;
+    }
+}
+
+uint8_t pinLevel(uint8_t pin) {
+    return pin < SIM_NUM_PINS ? pinLevels[pin] : LOW;
+}
+
+uint32_t pinDuty(uint8_t pin) {
+    initPinChannels();
+    if (pin >= SIM_NUM_PINS || pinChannel[pin] < 0) return 0;
+    return channelDuty[pinChannel[pin]];
+}
+
+void setAnalog(uint8_t pin, uint16_t value, uint16_t noiseAmplitude) {
+    if (pin >= SIM_NUM_PINS) return;
+    analogValue[pin] = value;
+    analogNoise[pin] = noiseAmplitude;
+}
+
+void rfSend(unsigned long code) {
+    rfCodes.push_back(code);
+}
+
+void setCurrentSource(CurrentSource source) {
+    currentSource = source;
+}
+
+void setLogEnabled(bool enabled) {
+    logEnabled = enabled;
+}
+
+float noise() {
+    rngState = rngState * 1664525UL + 1013904223UL;
+    return ((rngState >> 8) / (float)(1UL << 24)) * 2.0f - 1.0f;
+}
+
+}
+
+// ===== Zeit =====
+
+unsigned long millis() {
+    return simMillis;
+}
+
+unsigned long micros() {
+    return simMillis * 1000UL;
+}
+
+void delay(uint32_t ms) {
+    sim::advance(ms);
+}
+
+void yield() {}
+
+// ===== GPIO / ADC / LEDC =====
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < SIM_NUM_PINS) pinLevels[pin] = val ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    return sim::pinLevel(pin);
+}
+
+uint16_t analogRead(uint8_t pin) {
+    if (pin >= SIM_NUM_PINS) return 0;
+    int value = analogValue[pin] + (int)(sim::noise() * analogNoise[pin]);
+    return (uint16_t)constrain(value, 0, 4095);
+}
+
+void analogSetAttenuation(adc_attenuation_t attenuation) {
+    (void)attenuation;
+}
+
+void analogReadResolution(uint8_t bits) {
+    (void)bits;
+}
+
+double ledcSetup(uint8_t channel, double freq, uint8_t resolution_bits) {
+    (void)resolution_bits;
+    if (channel < SIM_NUM_LEDC_CHANNELS) channelDuty[channel] = 0;
+    return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+    initPinChannels();
+    if (pin < SIM_NUM_PINS && channel < SIM_NUM_LEDC_CHANNELS) pinChannel[pin] = channel;
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+    if (channel < SIM_NUM_LEDC_CHANNELS) channelDuty[channel] = duty;
+}
+
+long random(long maxValue) {
+    return maxValue > 0 ? (long)((sim::noise() * 0.5f + 0.5f) * (maxValue - 1)) : 0;
+}
+
+long random(long minValue, long maxValue) {
+    return minValue + random(maxValue - minValue);
+}
+
+// ===== String =====
+
+static std::string formatInteger(unsigned long value, bool negative, unsigned char base) {
+    char buf[40];
+    if (base == HEX) {
+        snprintf(buf, sizeof(buf), "%lx", value);
+    } else {
+        snprintf(buf, sizeof(buf), "%s%lu", negative ? "-" : "", value);
+    }
+    return buf;
+}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) {
+    bool negative = value < 0 && base != HEX;
+    s = formatInteger(negative ? (unsigned long)(-value) : (unsigned long)value, negative, base);
+}
+
+String::String(unsigned long value, unsigned char base) {
+    s = formatInteger(value, false, base);
+}
+
+String::String(float value, unsigned char decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned char decimals) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+    s = buf;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t pos = s.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const char* str, unsigned int from) const {
+    size_t pos = s.find(str, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int from) const {
+    return from < s.length() ? String(s.substr(from)) : String();
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s.length()) return String();
+    return String(s.substr(from, to - from));
+}
+
+bool String::endsWith(const String& suffix) const {
+    return s.length() >= suffix.s.length() &&
+           s.compare(s.length() - suffix.s.length(), suffix.s.length(), suffix.s) == 0;
+}
+
+void String::toUpperCase() {
+    for (auto& c : s) c = toupper((unsigned char)c);
+}
+
+void String::toLowerCase() {
+    for (auto& c : s) c = tolower((unsigned char)c);
+}
+
+void String::trim() {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    size_t end = s.find_last_not_of(" \t\r\n");
+    s = (start == std::string::npos) ? std::string() : s.substr(start, end - start + 1);
+}
+
+// ===== Serial =====
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    if (!logEnabled) return 0;
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n > 0 ? n : 0;
+}
+
+size_t HardwareSerial::print(const char* str) {
+    return printf("%s", str);
+}
+
+size_t HardwareSerial::print(char c) {
+    return printf("%c", c);
+}
+
+size_t HardwareSerial::print(int value, int base) {
+    return print((long)value, base);
+}
+
+size_t HardwareSerial::print(unsigned int value, int base) {
+    return print((unsigned long)value, base);
+}
+
+size_t HardwareSerial::print(long value, int base) {
+    return print(String(value, (unsigned char)base));
+}
+
+size_t HardwareSerial::print(unsigned long value, int base) {
+    return print(String(value, (unsigned char)base));
+}
+
+size_t HardwareSerial::print(double value, int digits) {
+    return print(String(value, (unsigned char)digits));
+}
+
+// ===== Preferences =====
+
+static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> nvs;
+
+bool Preferences::begin(const char* name, bool ro) {
+    ns = name;
+    readOnly = ro;
+    opened = true;
+    return true;
+}
+
+void Preferences::end() {
+    opened = false;
+}
+
+bool Preferences::clear() {
+    if (!opened || readOnly) return false;
+    nvs[ns].clear();
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!opened || readOnly) return false;
+    return nvs[ns].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) const {
+    auto it = nvs.find(ns);
+    return it != nvs.end() && it->second.count(key) > 0;
+}
+
+bool Preferences::put(const char* key, const void* value, size_t len) {
+    if (!opened || readOnly) return false;
+    const uint8_t* bytes = (const uint8_t*)value;
+    nvs[ns][key] = std::vector<uint8_t>(bytes, bytes + len);
+    return true;
+}
+
+size_t Preferences::get(const char* key, void* value, size_t len) const {
+    auto it = nvs.find(ns);
+    if (it == nvs.end()) return 0;
+    auto entry = it->second.find(key);
+    if (entry == it->second.end() || entry->second.size() > len) return 0;
+    memcpy(value, entry->second.data(), entry->second.size());
+    return entry->second.size();
+}
+
+uint8_t Preferences::getUChar(const char* key, uint8_t defaultValue) const {
+    uint8_t value;
+    return get(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+uint16_t Preferences::getUShort(const char* key, uint16_t defaultValue) const {
+    uint16_t value;
+    return get(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+int32_t Preferences::getInt(const char* key, int32_t defaultValue) const {
+    int32_t value;
+    return get(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) const {
+    uint32_t value;
+    return get(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+float Preferences::getFloat(const char* key, float defaultValue) const {
+    float value;
+    return get(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) const {
+    char buf[256];
+    return get(key, buf, sizeof(buf)) > 0 ? String(buf) : defaultValue;
+}
+
+size_t Preferences::getBytesLength(const char* key) const {
+    auto it = nvs.find(ns);
+    if (it == nvs.end()) return 0;
+    auto entry = it->second.find(key);
+    return entry == it->second.end() ? 0 : entry->second.size();
+}
+
+// ===== INA219 =====
+
+float Adafruit_INA219::getCurrent_mA() {
+    return currentSource ? currentSource(addr) : 0.0f;
+}
+
+float Adafruit_INA219::getBusVoltage_V() {
+    return 24.0f;
+}
+
+float Adafruit_INA219::getShuntVoltage_mV() {
+    return getCurrent_mA() * 0.1f;
+}
+
+// ===== RCSwitch =====
+
+bool RCSwitch::available() {
+    return !rfCodes.empty();
+}
+
+unsigned long RCSwitch::getReceivedValue() {
+    return rfCodes.empty() ? 0 : rfCodes.front();
+}
+
+void RCSwitch::resetAvailable() {
+    if (!rfCodes.empty()) rfCodes.pop_front();
+}
+
+// ===== FreeRTOS =====
+
+struct SimQueue {
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* parameter, UBaseType_t priority,
+                                   TaskHandle_t* handle, BaseType_t coreId) {
+    // Tasks laufen nicht eigenständig - der Simulationstreiber ruft deren Arbeit auf
+    (void)fn; (void)stackDepth; (void)parameter; (void)priority; (void)coreId;
+    if (handle) *handle = (TaskHandle_t)name;
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    sim::advance(ticks);
+}
+
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t timeIncrement) {
+    *previousWakeTime += timeIncrement;
+    if ((int32_t)(*previousWakeTime - simMillis) > 0) sim::advance(*previousWakeTime - simMillis);
+}
+
+TickType_t xTaskGetTickCount() {
+    return simMillis;
+}
+
+// Single-threaded: es gibt genau einen "Task" (den Hauptloop), der wartet
+static uint32_t notifyCount = 0;
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return (TaskHandle_t)"loopTask";
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    (void)task;
+    notifyCount++;
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    for (TickType_t waited = 0; notifyCount == 0 && waited < ticksToWait; waited++) {
+        sim::advance(1);
+    }
+    uint32_t count = notifyCount;
+    if (count > 0) notifyCount = clearCountOnExit ? 0 : count - 1;
+    return count;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    SimQueue* queue = new SimQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    (void)ticksToWait;
+    if (!queue || queue->items.size() >= queue->length) return pdFALSE;
+    const uint8_t* bytes = (const uint8_t*)item;
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    (void)ticksToWait;
+    if (!queue || queue->items.empty()) return pdFALSE;
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return queue ? queue->items.size() : 0;
+}
+
+// ===== esp_timer =====
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    uint64_t due_us;
+    uint64_t period_us;
+    bool active;
+};
+
+static std::vector<esp_timer*> timers;
+
+static void fireTimers() {
+    uint64_t now_us = (uint64_t)simMillis * 1000ULL;
+    for (size_t i = 0; i < timers.size(); i++) {
+        esp_timer* t = timers[i];
+        if (!t->active || t->due_us > now_us) continue;
+        if (t->period_us > 0) {
+            t->due_us += t->period_us;
+            if (t->due_us <= now_us) t->due_us = now_us + t->period_us;
+        } else {
+            t->active = false;
+        }
+        t->callback(t->arg);
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    esp_timer* t = new esp_timer();
+    t->callback = args->callback;
+    t->arg = args->arg;
+    t->due_us = 0;
+    t->period_us = 0;
+    t->active = false;
+    timers.push_back(t);
+    *handle = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->due_us = (uint64_t)simMillis * 1000ULL + timeout_us;
+    timer->period_us = 0;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->due_us = (uint64_t)simMillis * 1000ULL + period_us;
+    timer->period_us = period_us;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer->active) return ESP_ERR_INVALID_STATE;
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    for (size_t i = 0; i < timers.size(); i++) {
+        if (timers[i] == timer) {
+            timers.erase(timers.begin() + i);
+            break;
+        }
+    }
+    delete timer;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return timer->active;
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)simMillis * 1000LL;
+}
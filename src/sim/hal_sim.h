@@ -0,0 +1,37 @@
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+// ===== Host-HAL: Steuerschnittstelle der Simulation =====
+// Die Shims in sim/include/ (Arduino.h, Preferences.h, ...) greifen auf diesen
+// Zustand zu. Die simulierte Zeit läuft nur über advance() bzw. delay().
+
+#include <Arduino.h>
+
+namespace sim {
+
+typedef void (*TickHook)(uint32_t nowMs);
+typedef float (*CurrentSource)(uint8_t inaAddress);
+
+// Zeit
+uint32_t now();
+void advance(uint32_t ms);          // Simulierte Zeit in 1ms-Schritten weiterlaufen lassen
+void addTickHook(TickHook hook);    // Wird jede simulierte Millisekunde aufgerufen (Core-0-Tasks, Anlage)
+
+// GPIO / LEDC
+uint8_t pinLevel(uint8_t pin);
+uint32_t pinDuty(uint8_t pin);      // LEDC-Tastgrad am Pin (0 wenn kein Kanal zugeordnet)
+
+// Eingänge
+void setAnalog(uint8_t pin, uint16_t value, uint16_t noise = 0);
+void rfSend(unsigned long code);
+void setCurrentSource(CurrentSource source);
+
+// Ausgabe
+void setLogEnabled(bool enabled);
+
+// Deterministischer Zufall für Rauschen (-1.0 .. 1.0)
+float noise();
+
+}
+
+#endif
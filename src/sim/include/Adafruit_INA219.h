@@ -0,0 +1,27 @@
+#ifndef SIM_ADAFRUIT_INA219_H
+#define SIM_ADAFRUIT_INA219_H
+
+// ===== Host-HAL: INA219-Ersatz =====
+// Liefert den Motorstrom der simulierten Anlage für die jeweilige I2C-Adresse.
+
+#include <Arduino.h>
+
+class Adafruit_INA219 {
+private:
+    uint8_t addr;
+
+public:
+    Adafruit_INA219(uint8_t address = 0x40) : addr(address) {}
+
+    bool begin() { return true; }
+    void setCalibration_32V_2A() {}
+    void setCalibration_32V_1A() {}
+    void setCalibration_16V_400mA() {}
+
+    float getCurrent_mA();
+    float getBusVoltage_V();
+    float getShuntVoltage_mV();
+    float getPower_mW() { return getBusVoltage_V() * getCurrent_mA(); }
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+// ===== Host-HAL: NVS-Ersatz =====
+// Hält alle Namespaces im RAM. Die Simulation kann Werte vorbelegen
+// (z.B. Laufzeiten), bevor die Controller ihre Konfiguration laden.
+
+#include <Arduino.h>
+
+class Preferences {
+private:
+    std::string ns;
+    bool opened;
+    bool readOnly;
+
+    bool put(const char* key, const void* value, size_t len);
+    size_t get(const char* key, void* value, size_t len) const;
+
+public:
+    Preferences() : opened(false), readOnly(false) {}
+
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key) const;
+
+    size_t putUChar(const char* key, uint8_t value) { return put(key, &value, sizeof(value)) ? sizeof(value) : 0; }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+    size_t putUShort(const char* key, uint16_t value) { return put(key, &value, sizeof(value)) ? sizeof(value) : 0; }
+    size_t putInt(const char* key, int32_t value) { return put(key, &value, sizeof(value)) ? sizeof(value) : 0; }
+    size_t putUInt(const char* key, uint32_t value) { return put(key, &value, sizeof(value)) ? sizeof(value) : 0; }
+    size_t putULong(const char* key, uint32_t value) { return putUInt(key, value); }
+    size_t putFloat(const char* key, float value) { return put(key, &value, sizeof(value)) ? sizeof(value) : 0; }
+    size_t putString(const char* key, const String& value) { return put(key, value.c_str(), value.length() + 1) ? value.length() : 0; }
+    size_t putBytes(const char* key, const void* value, size_t len) { return put(key, value, len) ? len : 0; }
+
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) const;
+    bool getBool(const char* key, bool defaultValue = false) const { return getUChar(key, defaultValue ? 1 : 0) != 0; }
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0) const;
+    int32_t getInt(const char* key, int32_t defaultValue = 0) const;
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) const;
+    uint32_t getULong(const char* key, uint32_t defaultValue = 0) const { return getUInt(key, defaultValue); }
+    float getFloat(const char* key, float defaultValue = NAN) const;
+    String getString(const char* key, const String& defaultValue = String()) const;
+    size_t getBytesLength(const char* key) const;
+    size_t getBytes(const char* key, void* buf, size_t maxLen) const { return get(key, buf, maxLen); }
+};
+
+#endif
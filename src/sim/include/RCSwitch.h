@@ -0,0 +1,19 @@
+#ifndef SIM_RCSWITCH_H
+#define SIM_RCSWITCH_H
+
+// ===== Host-HAL: RCSwitch-Ersatz =====
+// Empfangene Codes werden von der Simulation über sim::rfSend() eingespeist.
+
+#include <Arduino.h>
+
+class RCSwitch {
+public:
+    void enableReceive(int interrupt) { (void)interrupt; }
+    void disableReceive() {}
+
+    bool available();
+    unsigned long getReceivedValue();
+    void resetAvailable();
+};
+
+#endif
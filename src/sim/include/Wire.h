@@ -0,0 +1,18 @@
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+// ===== Host-HAL: I2C-Ersatz =====
+// Die INA219-Shims lesen direkt aus der Anlage; der Bus selbst hat keine Funktion.
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+    bool begin() { return true; }
+    bool begin(int sda, int scl, uint32_t frequency = 0) { (void)sda; (void)scl; (void)frequency; return true; }
+    bool setClock(uint32_t frequency) { (void)frequency; return true; }
+};
+
+extern TwoWire Wire;
+
+#endif
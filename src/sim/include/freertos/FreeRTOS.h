@@ -0,0 +1,36 @@
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+// ===== Host-HAL: FreeRTOS-Ersatz =====
+// Die Simulation ist single-threaded: Tasks werden nur registriert, ihre
+// Arbeit ruft der Simulationstreiber direkt auf. Warten verstreicht
+// simulierte Zeit.
+
+#include <Arduino.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdFAIL  0
+#define pdPASS  1
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+// Spinlocks (ESP32 portmacro.h) - single-threaded ohne Wirkung
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
+
+#endif
@@ -0,0 +1,169 @@
+#include "shutter_plant.h"
+#include "hal_sim.h"
+#include "../config.h"
+
+PlantMotor ShutterPlant::motors[PLANT_NUM_MOTORS];
+uint32_t ShutterPlant::relayOnSince = 0;
+bool ShutterPlant::relayWasOn = false;
+
+static PlantMotor makeMotor(uint8_t ren, uint8_t len, uint8_t ina, uint32_t openMs, uint32_t closeMs) {
+    PlantMotor m;
+    m.rEnPin = ren;
+    m.lEnPin = len;
+#if PWM_PER_MOTOR
+    // RPWM/LPWM an den Enable-GPIOs, R_EN/L_EN fest auf 3,3V
+    m.rpwmPin = ren;
+    m.lpwmPin = len;
+#else
+    m.rpwmPin = RPWM_ALL;
+    m.lpwmPin = LPWM_ALL;
+#endif
+    m.inaAddress = ina;
+    m.openTimeMs = openMs;
+    m.closeTimeMs = closeMs;
+    m.loadFactor = 1.0f;
+    m.inertiaMs = PLANT_INERTIA_MS;
+    m.position = 0.0f;
+    m.speed = 0.0f;
+    m.current_mA = 0.0f;
+    m.atEndStop = true;
+    return m;
+}
+
+void ShutterPlant::begin() {
+    // Leicht unterschiedliche Rollläden: Schließen geht mit der Schwerkraft schneller
+    motors[0] = makeMotor(M1_R_EN, M1_L_EN, INA219_ADDR_M1, 18000, 16500);
+    motors[1] = makeMotor(M2_R_EN, M2_L_EN, INA219_ADDR_M2, 21000, 19000);
+    motors[2] = makeMotor(M3_R_EN, M3_L_EN, INA219_ADDR_M3, 17500, 16000);
+    motors[3] = makeMotor(M4_R_EN, M4_L_EN, INA219_ADDR_M4, 24000, 22000);
+
+    relayOnSince = 0;
+    relayWasOn = false;
+
+    sim::addTickHook(step);
+    sim::setCurrentSource(readCurrent);
+}
+
+bool ShutterPlant::isPowered() {
+    return relayWasOn && sim::now() - relayOnSince >= PLANT_RELAY_SETTLE_MS;
+}
+
+float ShutterPlant::drive(const PlantMotor& m, int8_t* dir) {
+    *dir = 0;
+    if (!isPowered()) return 0.0f;
+
+    uint32_t duty = 0;
+
+#if PWM_PER_MOTOR
+    uint32_t rDuty = sim::pinDuty(m.rpwmPin);
+    uint32_t lDuty = sim::pinDuty(m.lpwmPin);
+    if (rDuty > 0 && lDuty == 0) {
+        duty = rDuty;
+        *dir = 1;
+    } else if (lDuty > 0 && rDuty == 0) {
+        duty = lDuty;
+        *dir = -1;
+    }
+#else
+    bool ren = sim::pinLevel(m.rEnPin) == HIGH;
+    bool len = sim::pinLevel(m.lEnPin) == HIGH;
+
+    if (ren && !len) {
+        duty = sim::pinDuty(m.rpwmPin);
+        if (duty > 0) *dir = 1;
+    } else if (len && !ren) {
+        duty = sim::pinDuty(m.lpwmPin);
+        if (duty > 0) *dir = -1;
+    }
+#endif
+
+    float d = duty / (float)((1 << PWM_RESOLUTION) - 1);
+    return d;
+}
+
+void ShutterPlant::step(uint32_t nowMs) {
+    bool relay = sim::pinLevel(MOTOR_POWER_RELAY_PIN) == (RELAY_ACTIVE_LOW ? LOW : HIGH);
+    if (relay && !relayWasOn) relayOnSince = nowMs;
+    relayWasOn = relay;
+
+    for (int i = 0; i < PLANT_NUM_MOTORS; i++) {
+        PlantMotor& m = motors[i];
+
+        int8_t dir;
+        float duty = drive(m, &dir);
+        float effective = max(0.0f, (duty - PLANT_DEADBAND) / (1.0f - PLANT_DEADBAND));
+        float targetSpeed = dir * effective / m.loadFactor;
+
+        // Endanschlag blockiert die Bewegung in Fahrtrichtung
+        bool blocked = (dir > 0 && m.position >= 1.0f) || (dir < 0 && m.position <= 0.0f);
+        if (blocked) targetSpeed = 0.0f;
+
+        // Ohne Antrieb bremst nur die Reibung: der Motor läuft über den Weg hinaus, den er
+        // beim Anlauf hinter der Ansteuerung zurückgeblieben ist (Nachlauf = inertiaMs)
+        float tau = (dir != 0) ? m.inertiaMs : 2.0f * m.inertiaMs;
+        m.speed += (targetSpeed - m.speed) / max(tau, 1.0f);
+        if (blocked) m.speed = 0.0f;
+
+        if (m.speed > 0.0f) {
+            m.position += m.speed / m.openTimeMs;
+        } else if (m.speed < 0.0f) {
+            m.position += m.speed / m.closeTimeMs;
+        }
+        m.position = constrain(m.position, 0.0f, 1.0f);
+        m.atEndStop = (m.position <= 0.0f || m.position >= 1.0f);
+
+        // Strom: Laststrom + Gegen-EMK-Defizit (Anlauf / Blockieren)
+        float targetCurrent = 0.0f;
+        if (dir != 0) {
+            float deficit = max(0.0f, duty - fabsf(m.speed) * m.loadFactor);
+            targetCurrent = PLANT_RUN_MA * m.loadFactor * min(1.0f, effective * 2.0f + 0.2f)
+                          + PLANT_STALL_MA * deficit;
+        }
+        m.current_mA += (targetCurrent - m.current_mA) / PLANT_CURRENT_TAU_MS;
+    }
+}
+
+float ShutterPlant::readCurrent(uint8_t inaAddress) {
+    for (int i = 0; i < PLANT_NUM_MOTORS; i++) {
+        if (motors[i].inaAddress != inaAddress) continue;
+        float value = motors[i].current_mA + sim::noise() * PLANT_NOISE_MA;
+        // INA219 misst vorzeichenbehaftet: Schließen = negativer Strom
+        bool closing = motors[i].speed < 0.0f;
+        return closing ? -value : value;
+    }
+    return 0.0f;
+}
+
+float ShutterPlant::getTruePosition(uint8_t motor) {
+    return motors[motor - 1].position * 100.0f;
+}
+
+void ShutterPlant::setTruePosition(uint8_t motor, float percent) {
+    motors[motor - 1].position = constrain(percent, 0.0f, 100.0f) / 100.0f;
+    motors[motor - 1].speed = 0.0f;
+}
+
+void ShutterPlant::setTravelTimes(uint8_t motor, uint32_t openMs, uint32_t closeMs) {
+    motors[motor - 1].openTimeMs = openMs;
+    motors[motor - 1].closeTimeMs = closeMs;
+}
+
+void ShutterPlant::setLoadFactor(uint8_t motor, float factor) {
+    motors[motor - 1].loadFactor = factor;
+}
+
+void ShutterPlant::setInertia(uint8_t motor, uint32_t inertiaMs) {
+    motors[motor - 1].inertiaMs = inertiaMs;
+}
+
+float ShutterPlant::getCurrent(uint8_t motor) {
+    return motors[motor - 1].current_mA;
+}
+
+bool ShutterPlant::isAtEndStop(uint8_t motor) {
+    return motors[motor - 1].atEndStop;
+}
+
+bool ShutterPlant::isMoving(uint8_t motor) {
+    return fabsf(motors[motor - 1].speed) > 0.001f;
+}
@@ -0,0 +1,65 @@
+#ifndef SHUTTER_PLANT_H
+#define SHUTTER_PLANT_H
+
+// ===== Simulierte Rollladen-Anlage =====
+// Vier Motoren hinter Relais + BTS7960: Fahrzeit je Richtung, Trägheit,
+// Endanschläge und Stromaufnahme (Anlauf, Last, Blockierstrom).
+// Die Anlage liest die Ausgänge über die Host-HAL (EN-Pins, LEDC, Relais)
+// und liefert den Strom an die INA219-Shims.
+
+#include <Arduino.h>
+
+#define PLANT_NUM_MOTORS 4
+
+#define PLANT_RELAY_SETTLE_MS 40       // Netzteil stabil nach Relais-EIN
+#define PLANT_INERTIA_MS 40            // Nachlauf (Startwert): Zeitkonstante mit Antrieb, ohne doppelt
+#define PLANT_CURRENT_TAU_MS 5         // Elektrische Zeitkonstante
+#define PLANT_DEADBAND 0.2f            // Tastgrad-Anteil ohne Bewegung (Haftreibung)
+#define PLANT_RUN_MA 650.0f            // Laststrom bei Nenndrehzahl
+#define PLANT_STALL_MA 2600.0f         // Zusätzlicher Strom bei blockiertem Motor
+#define PLANT_NOISE_MA 20.0f           // Messrauschen INA219
+
+struct PlantMotor {
+    uint8_t rEnPin;
+    uint8_t lEnPin;
+    uint8_t rpwmPin;
+    uint8_t lpwmPin;
+    uint8_t inaAddress;
+
+    uint32_t openTimeMs;               // Wahre Fahrzeit 0->100% bei vollem Tastgrad
+    uint32_t closeTimeMs;              // Wahre Fahrzeit 100->0% bei vollem Tastgrad
+    float loadFactor;                  // >1 = schwergängig (Kälte, Unterspannung)
+    uint32_t inertiaMs;                // Weg nach dem Abschalten über den angesteuerten Weg hinaus
+
+    float position;                    // 0.0 .. 1.0
+    float speed;                       // normiert, -1.0 .. 1.0
+    float current_mA;
+    bool atEndStop;
+};
+
+class ShutterPlant {
+private:
+    static PlantMotor motors[PLANT_NUM_MOTORS];
+    static uint32_t relayOnSince;
+    static bool relayWasOn;
+
+    static void step(uint32_t nowMs);
+    static float readCurrent(uint8_t inaAddress);
+    static float drive(const PlantMotor& m, int8_t* dir);
+
+public:
+    static void begin();
+
+    // Motoren 1-4 (wie MotorController-ID)
+    static float getTruePosition(uint8_t motor);
+    static void setTruePosition(uint8_t motor, float percent);
+    static void setTravelTimes(uint8_t motor, uint32_t openMs, uint32_t closeMs);
+    static void setLoadFactor(uint8_t motor, float factor);
+    static void setInertia(uint8_t motor, uint32_t inertiaMs);
+    static float getCurrent(uint8_t motor);
+    static bool isAtEndStop(uint8_t motor);
+    static bool isMoving(uint8_t motor);
+    static bool isPowered();
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "status_snapshot.h"
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+MotorSnapshot StatusSnapshot::motors[SNAPSHOT_MOTOR_COUNT];
+SystemStatus StatusSnapshot::system = {0, 0, 0, 0, 0};
+bool StatusSnapshot::motorsValid = false;
+unsigned long StatusSnapshot::systemAt = 0;
+char StatusSnapshot::json[SNAPSHOT_JSON_MAX] = "{}";
+size_t StatusSnapshot::jsonLength = 2;
+uint32_t StatusSnapshot::version = 0;
+uint32_t StatusSnapshot::sequence = 0;
+uint32_t StatusSnapshot::bootId = 0;
+
+void StatusSnapshot::begin() {
+    bootId = esp_random();
+}
+
+bool StatusSnapshot::updateMotors(const MotorSnapshot* current, uint8_t count) {
+    bool changed = !motorsValid;
+    for (uint8_t i = 0; i < count && i < SNAPSHOT_MOTOR_COUNT; i++) {
+        const MotorSnapshot& cur = current[i];
+        MotorSnapshot& last = motors[i];
+        // Strom schwankt während der Fahrt: erst ab STATUS_CURRENT_DELTA_MA
+        if (changed ||
+            cur.position != last.position || cur.state != last.state ||
+            cur.calibrated != last.calibrated || cur.overcurrent != last.overcurrent ||
+            cur.queued != last.queued || cur.calibrating != last.calibrating ||
+            abs(cur.current - last.current) >= STATUS_CURRENT_DELTA_MA) {
+            last = cur;
+            changed = true;
+        }
+    }
+    if (!changed) return false;
+    
+    motorsValid = true;
+    publish();
+    return true;
+}
+
+void StatusSnapshot::updateSystem(const SystemStatus& status) {
+    system = status;
+    systemAt = millis();
+    if (systemAt == 0) systemAt = 1;
+    publish();
+}
+
+void StatusSnapshot::publish() {
+    // Außerhalb des Seqlocks serialisieren, dann nur noch kopieren
+    StaticJsonDocument<1536> doc;
+    for (uint8_t i = 0; i < SNAPSHOT_MOTOR_COUNT; i++) {
+        char key[8];
+        snprintf(key, sizeof(key), "motor%d", i + 1);
+        JsonObject m = doc[key].to<JsonObject>();
+        m["position"] = motors[i].position;
+        m["calibrated"] = motors[i].calibrated;
+        m["state"] = motors[i].state;
+        m["current"] = motors[i].current;
+        m["overcurrent"] = motors[i].overcurrent;
+        m["queued"] = motors[i].queued;
+        m["calibrating"] = motors[i].calibrating;
+    }
+    
+    JsonObject sys = doc["system"].to<JsonObject>();
+    sys["heap_free"] = system.heapFree;
+    sys["heap_min_free"] = system.heapMinFree;
+    sys["heap_max_block"] = system.heapMaxBlock;
+    sys["heap_fragmentation"] = system.heapFragmentation;
+    sys["uptime"] = system.uptime;
+    
+    char buffer[SNAPSHOT_JSON_MAX];
+    size_t length = serializeJson(doc, buffer, sizeof(buffer));
+    
+    uint32_t seq = sequence;
+    __atomic_store_n(&sequence, seq + 1, __ATOMIC_RELAXED);     // ungerade: Schreiben beginnt
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(json, buffer, length + 1);
+    jsonLength = length;
+    __atomic_store_n(&version, version + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&sequence, seq + 2, __ATOMIC_RELEASE);     // gerade: fertig
+}
+
+size_t StatusSnapshot::read(char* out, size_t size, uint32_t* versionOut) {
+    for (;;) {
+        uint32_t before = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            // Schreiber mitten im Kopieren - ggf. auf demselben Core mit niedrigerer
+            // Priorität, daher abgeben statt aktiv zu warten
+            vTaskDelay(1);
+            continue;
+        }
+        
+        size_t length = min(jsonLength, size - 1);
+        uint32_t v = version;
+        memcpy(out, json, length);
+        
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&sequence, __ATOMIC_RELAXED) == before) {
+            out[length] = '\0';
+            if (versionOut) *versionOut = v;
+            return length;
+        }
+    }
+}
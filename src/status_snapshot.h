@@ -0,0 +1,72 @@
+#ifndef STATUS_SNAPSHOT_H
+#define STATUS_SNAPSHOT_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define SNAPSHOT_MOTOR_COUNT 4
+#define SNAPSHOT_JSON_MAX 1024          // Fertiges /status-JSON
+#define SNAPSHOT_ETAG_MAX 24            // "s<boot>-<version>" mit Anführungszeichen
+
+// Systemstatus (Heap-Fragmentierung im Dauerbetrieb beobachten)
+struct SystemStatus {
+    uint32_t heapFree;
+    uint32_t heapMinFree;           // Tiefststand seit Boot
+    uint32_t heapMaxBlock;          // Größter zusammenhängender Block
+    uint8_t heapFragmentation;      // % = 100 - maxBlock / free
+    uint32_t uptime;                // s
+};
+
+// Felder eines Motors in /status
+struct MotorSnapshot {
+    uint8_t position;               // %
+    uint8_t state;                  // MotorState
+    int16_t current;                // mA
+    bool calibrated;
+    bool overcurrent;
+    bool queued;
+    bool calibrating;
+};
+
+// Versionierter Status aller Motoren als fertig serialisiertes JSON.
+// Genau ein Schreiber (Status-Task im Hauptloop) serialisiert nur, wenn sich
+// ein Feld ändert, und zählt dann die Version hoch. Leser in anderen Tasks
+// (AsyncTCP, ...) kopieren lock-frei per Seqlock: ungerade Sequenz = Schreiber
+// aktiv, geänderte Sequenz nach dem Kopieren = nochmal lesen.
+class StatusSnapshot {
+private:
+    static MotorSnapshot motors[SNAPSHOT_MOTOR_COUNT];
+    static SystemStatus system;
+    static bool motorsValid;
+    static unsigned long systemAt;
+    
+    static char json[SNAPSHOT_JSON_MAX];
+    static size_t jsonLength;
+    static uint32_t version;
+    static uint32_t sequence;
+    static uint32_t bootId;         // Zufall pro Boot: version beginnt nach jedem Neustart bei 0
+    
+    static void publish();
+    
+public:
+    static void begin();            // Aus setup() vor dem Webserver aufrufen
+    
+    // ===== Schreiber (nur Hauptloop) =====
+    // true = mindestens ein Feld geändert, neue Version
+    static bool updateMotors(const MotorSnapshot* current, uint8_t count);
+    // Heap-Werte schwanken ständig: nur alle SNAPSHOT_SYSTEM_INTERVAL_MS übernehmen
+    static bool systemDue() { return systemAt == 0 || millis() - systemAt >= SNAPSHOT_SYSTEM_INTERVAL_MS; }
+    static void updateSystem(const SystemStatus& status);
+    static const SystemStatus& getSystem() { return system; }
+    
+    // ===== Leser (beliebiger Task) =====
+    static uint32_t getVersion() { return __atomic_load_n(&version, __ATOMIC_ACQUIRE); }
+    // Kopiert das JSON nach out (nullterminiert), liefert Länge und Version der Kopie
+    static size_t read(char* out, size_t size, uint32_t* versionOut);
+    // "s<boot>-<version>": ein ETag von vor dem Neustart passt nie auf den neuen Zähler
+    static void formatEtag(uint32_t v, char* out, size_t size) {
+        snprintf(out, size, "\"s%08lx-%lu\"", (unsigned long)bootId, (unsigned long)v);
+    }
+};
+
+#endif
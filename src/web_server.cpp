@@ -1,119 +1,35 @@
 #include "web_server.h"
 #include "config.h"
+#include "scheduler.h"
+#include "web_ui.h"
+#include "status_snapshot.h"
 
-WebServerHandler::WebServerHandler() : server(WEB_SERVER_PORT) {}
+WebServerHandler::WebServerHandler() : server(WEB_SERVER_PORT), events("/events") {
+    for (uint8_t i = 0; i < WEB_MOTOR_COUNT; i++) {
+        lastEventValid[i] = false;
+        lastEventAt[i] = 0;
+    }
+    eventResync = false;
+}
 
 void WebServerHandler::begin() {
-    // Root
+    // Root: gzip aus dem Flash (web/index.html, erzeugt von tools/build_web.py).
+    // Browser fragt mit If-None-Match nach und bekommt 304 ohne Inhalt.
     server.on("/", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/html", R"rawliteral(
-<!DOCTYPE html>
-<html>
-<head>
-    <meta charset="UTF-8">
-    <meta name="viewport" content="width=device-width, initial-scale=1.0">
-    <title>Velux Controller</title>
-    <style>
-        * { margin: 0; padding: 0; box-sizing: border-box; }
-        body { font-family: Arial, sans-serif; background: #1a1a1a; color: #fff; padding: 20px; }
-        .container { max-width: 1200px; margin: 0 auto; }
-        h1 { text-align: center; margin-bottom: 30px; color: #4CAF50; }
-        .motors { display: grid; grid-template-columns: repeat(auto-fit, minmax(300px, 1fr)); gap: 20px; }
-        .motor { background: #2a2a2a; border-radius: 10px; padding: 20px; border: 2px solid #333; }
-        .motor h2 { color: #4CAF50; margin-bottom: 15px; }
-        .controls { display: flex; gap: 10px; margin-bottom: 15px; }
-        button { flex: 1; padding: 15px; border: none; border-radius: 5px; cursor: pointer; font-size: 16px; font-weight: bold; transition: 0.3s; }
-        .btn-open { background: #4CAF50; color: white; }
-        .btn-open:hover { background: #45a049; }
-        .btn-close { background: #f44336; color: white; }
-        .btn-close:hover { background: #da190b; }
-        .btn-stop { background: #ff9800; color: white; }
-        .btn-stop:hover { background: #e68900; }
-        .slider { width: 100%; margin: 15px 0; }
-        .status { background: #333; padding: 10px; border-radius: 5px; margin: 10px 0; font-size: 14px; }
-        .learn { margin-top: 15px; padding-top: 15px; border-top: 1px solid #444; }
-        .learn button { background: #2196F3; }
-        .learn button:hover { background: #0b7dda; }
-        .all-controls { display: flex; gap: 20px; justify-content: center; margin-bottom: 30px; }
-        .btn-all { padding: 20px 40px; font-size: 18px; min-width: 200px; }
-    </style>
-</head>
-<body>
-    <div class="container">
-    <h1>🏠 Velux Rolladen Controller</h1>
-        <div class="all-controls">
-            <button class="btn-all btn-open" onclick="controlAll('OPEN')">🔼 ALLE AUF</button>
-            <button class="btn-all btn-close" onclick="controlAll('CLOSE')">🔽 ALLE ZU</button>
-        </div>
-        
-        <div class="motors" id="motors"></div>
-    </div>
-    
-    <script>
-        const motors = [1, 2, 3, 4];
-        
-        function createMotorCard(id) {
-            return "<div class=\"motor\">" +
-                "<h2>Motor " + id + "</h2>" +
-                "<div class=\"controls\">" +
-                "<button class=\"btn-open\" onclick=\"control(" + id + ", 'OPEN')\">AUF</button>" +
-                "<button class=\"btn-stop\" onclick=\"control(" + id + ", 'STOP')\">STOP</button>" +
-                "<button class=\"btn-close\" onclick=\"control(" + id + ", 'CLOSE')\">ZU</button>" +
-                "</div>" +
-                "<input type=\"range\" class=\"slider\" min=\"0\" max=\"100\" value=\"50\" onchange=\"control(" + id + ", this.value)\" id=\"slider" + id + "\">" +
-                "<div class=\"status\" id=\"status" + id + "\">Position: --%</div>" +
-                "<div class=\"learn\">" +
-                "<button onclick=\"learn(" + id + ", 'open')\">Oeffnungszeit lernen</button>" +
-                "<button onclick=\"learn(" + id + ", 'close')\">Schliesszeit lernen</button>" +
-                "</div>" +
-                "</div>";
-        }
-        
-        motors.forEach(function(id) {
-            document.getElementById("motors").innerHTML += createMotorCard(id);
-        });
-        
-        function control(motor, cmd) {
-            fetch("/motor" + motor + "/control?cmd=" + cmd)
-                .then(function(r) { return r.text(); })
-                .then(function(data) { console.log(data); });
-        }
-        
-        function controlAll(cmd) {
-            fetch("/all/control?cmd=" + cmd)
-                .then(function(r) { return r.text(); })
-                .then(function(data) { console.log(data); });
-        }
-        
-        function learn(motor, type) {
-            if (confirm("Motor " + motor + ": " + (type === "open" ? "Oeffnungszeit" : "Schliesszeit") + " lernen?")) {
-                fetch("/motor" + motor + "/learn?type=" + type)
-                    .then(function(r) { return r.text(); })
-                    .then(function(data) { alert(data); });
-            }
+        if (request->hasHeader("If-None-Match") &&
+            request->getHeader("If-None-Match")->value() == WEB_UI_ETAG) {
+            AsyncWebServerResponse *response = request->beginResponse(304);
+            response->addHeader("ETag", WEB_UI_ETAG);
+            response->addHeader("Cache-Control", WEB_UI_CACHE_CONTROL);
+            request->send(response);
+            return;
         }
         
-        function updateStatus() {
-            fetch("/status")
-                .then(function(r) { return r.json(); })
-                .then(function(data) {
-                    motors.forEach(function(id) {
-                        const m = data["motor" + id];
-                        if (m) {
-                            document.getElementById("status" + id).innerHTML = 
-                                "Position: " + m.position + "%, Kalibriert: " + (m.calibrated ? "JA" : "NEIN");
-                            document.getElementById("slider" + id).value = m.position;
-                        }
-                    });
-                });
-        }
-        
-        setInterval(updateStatus, 1000);
-        updateStatus();
-    </script>
-</body>
-</html>
-)rawliteral");
+        AsyncWebServerResponse *response = request->beginResponse_P(200, "text/html", WEB_UI_GZ, WEB_UI_GZ_LEN);
+        response->addHeader("Content-Encoding", "gzip");
+        response->addHeader("ETag", WEB_UI_ETAG);
+        response->addHeader("Cache-Control", WEB_UI_CACHE_CONTROL);
+        request->send(response);
     });
     
     // Motor Control
@@ -123,12 +39,14 @@ void WebServerHandler::begin() {
             if (request->hasParam("cmd")) {
                 String cmd = request->getParam("cmd")->value();
                 
-                if (i == 1 && onMotor1Command) onMotor1Command(cmd.c_str());
-                else if (i == 2 && onMotor2Command) onMotor2Command(cmd.c_str());
-                else if (i == 3 && onMotor3Command) onMotor3Command(cmd.c_str());
-                else if (i == 4 && onMotor4Command) onMotor4Command(cmd.c_str());
+                bool accepted = false;
+                if (i == 1 && onMotor1Command) accepted = onMotor1Command(cmd.c_str());
+                else if (i == 2 && onMotor2Command) accepted = onMotor2Command(cmd.c_str());
+                else if (i == 3 && onMotor3Command) accepted = onMotor3Command(cmd.c_str());
+                else if (i == 4 && onMotor4Command) accepted = onMotor4Command(cmd.c_str());
                 
-                request->send(200, "text/plain", "OK");
+                if (accepted) request->send(200, "text/plain", "OK");
+                else request->send(503, "text/plain", "Befehlsqueue voll");
             } else {
                 request->send(400, "text/plain", "Missing cmd");
             }
@@ -140,12 +58,12 @@ void WebServerHandler::begin() {
         if (request->hasParam("cmd")) {
             String cmd = request->getParam("cmd")->value();
             
-            if (onMotor1Command) onMotor1Command(cmd.c_str());
-            if (onMotor2Command) onMotor2Command(cmd.c_str());
-            if (onMotor3Command) onMotor3Command(cmd.c_str());
-            if (onMotor4Command) onMotor4Command(cmd.c_str());
-            
-            request->send(200, "text/plain", "OK - Alle Motoren");
+            // Ein Eintrag für alle: die Motoren starten im selben Durchlauf
+            if (onAllCommand && onAllCommand(cmd.c_str())) {
+                request->send(200, "text/plain", "OK - Alle Motoren");
+            } else {
+                request->send(503, "text/plain", "Befehlsqueue voll");
+            }
         } else {
             request->send(400, "text/plain", "Missing cmd");
         }
@@ -158,28 +76,157 @@ void WebServerHandler::begin() {
             if (request->hasParam("type")) {
                 String type = request->getParam("type")->value();
                 
-                if (i == 1 && onMotor1Learn) onMotor1Learn(type.c_str());
-                else if (i == 2 && onMotor2Learn) onMotor2Learn(type.c_str());
-                else if (i == 3 && onMotor3Learn) onMotor3Learn(type.c_str());
-                else if (i == 4 && onMotor4Learn) onMotor4Learn(type.c_str());
+                bool accepted = false;
+                if (i == 1 && onMotor1Learn) accepted = onMotor1Learn(type.c_str());
+                else if (i == 2 && onMotor2Learn) accepted = onMotor2Learn(type.c_str());
+                else if (i == 3 && onMotor3Learn) accepted = onMotor3Learn(type.c_str());
+                else if (i == 4 && onMotor4Learn) accepted = onMotor4Learn(type.c_str());
                 
-                request->send(200, "text/plain", "Learn gestartet");
+                if (accepted) request->send(200, "text/plain", "Learn gestartet");
+                else request->send(503, "text/plain", "Befehlsqueue voll");
             } else {
                 request->send(400, "text/plain", "Missing type");
             }
         });
     }
     
-    // Status
-    server.on("/status", HTTP_GET, [this](AsyncWebServerRequest *request){
-        if (getStatusJson) {
-            String json = getStatusJson();
-            request->send(200, "application/json", json);
+    server.on("/all/learn", HTTP_GET, [this](AsyncWebServerRequest *request){
+        if (request->hasParam("type")) {
+            String type = request->getParam("type")->value();
+            
+            if (onAllLearn && onAllLearn(type.c_str())) {
+                request->send(200, "text/plain", "Learn gestartet - Alle Motoren");
+            } else {
+                request->send(503, "text/plain", "Befehlsqueue voll");
+            }
         } else {
-            request->send(500, "text/plain", "Status nicht verfügbar");
+            request->send(400, "text/plain", "Missing type");
         }
     });
     
+    // Batch: mehrere Motoren in einem Request, gemeinsam gestartet.
+    // Der Body kann in mehreren Stücken kommen: in _tempObject sammeln, nach dem
+    // letzten Stück genau einmal parsen. Antwort erst im Request-Handler.
+    server.on("/api/batch", HTTP_POST, [](AsyncWebServerRequest *request){
+        const BatchBody* body = (const BatchBody*)request->_tempObject;
+        if (!body || !body->result) {
+            request->send(400, "text/plain", "JSON-Body fehlt");
+        } else if (strcmp(body->result, "OK") == 0) {
+            request->send(200, "text/plain", "OK");
+        } else {
+            request->send(400, "text/plain", body->result);
+        }
+    }, nullptr, [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+        BatchBody* body = (BatchBody*)request->_tempObject;
+        if (index == 0) {
+            // Die Bibliothek gibt _tempObject mit free() frei
+            size_t capacity = (total <= BATCH_JSON_MAX) ? total : 0;
+            free(body);
+            body = (BatchBody*)malloc(sizeof(BatchBody) + capacity);
+            request->_tempObject = body;
+            if (!body) return;
+            body->result = (total > BATCH_JSON_MAX) ? "Body zu groß" : nullptr;
+            body->received = 0;
+        }
+        if (!body || body->result) return;      // Schon entschieden (zu groß, Fehler)
+        
+        if (index != body->received || index + len > total) {
+            body->result = "Body unvollständig";
+            return;
+        }
+        char* buffer = (char*)(body + 1);
+        memcpy(buffer + index, data, len);
+        body->received += len;
+        if (body->received < total) return;
+        
+        CommandBatch batch;
+        const char* error = nullptr;
+        if (!parseCommandBatch(buffer, total, batch, &error)) {
+            body->result = error;
+        } else if (!onBatch || !onBatch(batch)) {
+            body->result = "Batch nicht angenommen";
+        } else {
+            body->result = "OK";
+        }
+    });
+    
+    // Status: fertiges JSON aus dem Snapshot (lock-frei), ETag = Version
+    server.on("/status", HTTP_GET, [](AsyncWebServerRequest *request){
+        char etag[SNAPSHOT_ETAG_MAX];
+        StatusSnapshot::formatEtag(StatusSnapshot::getVersion(), etag, sizeof(etag));
+        if (request->hasHeader("If-None-Match") &&
+            request->getHeader("If-None-Match")->value() == etag) {
+            AsyncWebServerResponse *response = request->beginResponse(304);
+            response->addHeader("ETag", etag);
+            response->addHeader("Cache-Control", "no-cache");
+            request->send(response);
+            return;
+        }
+        
+        char json[SNAPSHOT_JSON_MAX];
+        uint32_t version;
+        StatusSnapshot::read(json, sizeof(json), &version);
+        StatusSnapshot::formatEtag(version, etag, sizeof(etag));
+        
+        AsyncWebServerResponse *response = request->beginResponse(200, "application/json", json);
+        response->addHeader("ETag", etag);
+        response->addHeader("Cache-Control", "no-cache");
+        request->send(response);
+    });
+    
+    // Status-Stream: neuer Client bekommt beim nächsten Durchlauf den Vollstand
+    events.onConnect([this](AsyncEventSourceClient *){
+        __atomic_store_n(&eventResync, true, __ATOMIC_RELEASE);
+        Scheduler::wake(statusTask);
+    });
+    server.addHandler(&events);
+    
     server.begin();
     Serial.println("Webserver: Gestartet auf Port " + String(WEB_SERVER_PORT));
 }
+
+uint32_t WebServerHandler::updateEvents(const WebMotorState* states, uint8_t count) {
+    if (events.count() == 0) return UINT32_MAX;     // Niemand hört zu
+    
+    if (__atomic_exchange_n(&eventResync, false, __ATOMIC_ACQUIRE)) {
+        for (uint8_t i = 0; i < WEB_MOTOR_COUNT; i++) {
+            lastEventValid[i] = false;
+        }
+    }
+    
+    unsigned long now = millis();
+    bool anyMoving = false;
+    
+    for (uint8_t i = 0; i < count && i < WEB_MOTOR_COUNT; i++) {
+        const WebMotorState& cur = states[i];
+        WebMotorState& last = lastEvent[i];
+        bool full = !lastEventValid[i];
+        if (cur.moving) anyMoving = true;
+        
+        bool stateChanged = full || strcmp(cur.state, last.state) != 0;
+        bool flagsChanged = full || cur.calibrated != last.calibrated || cur.calibrating != last.calibrating;
+        bool positionChanged = full || cur.position != last.position;
+        
+        // Position während der Fahrt gedrosselt, Zustandswechsel immer sofort
+        if (!stateChanged && !flagsChanged &&
+            !(positionChanged && (!cur.moving || now - lastEventAt[i] >= WEB_EVENT_INTERVAL_MS))) {
+            continue;
+        }
+        
+        // Nur geänderte Felder
+        char msg[WEB_EVENT_MAX];
+        int len = snprintf(msg, sizeof(msg), "{\"m\":%d", i + 1);
+        if (positionChanged) len += snprintf(msg + len, sizeof(msg) - len, ",\"p\":%d", cur.position);
+        if (stateChanged) len += snprintf(msg + len, sizeof(msg) - len, ",\"s\":\"%s\"", cur.state);
+        if (flagsChanged) len += snprintf(msg + len, sizeof(msg) - len, ",\"k\":%d,\"c\":%d",
+                                          cur.calibrated, cur.calibrating);
+        snprintf(msg + len, sizeof(msg) - len, "}");
+        
+        events.send(msg, "motor");
+        last = cur;
+        lastEventAt[i] = now;
+        lastEventValid[i] = true;
+    }
+    
+    return anyMoving ? WEB_EVENT_INTERVAL_MS : UINT32_MAX;
+}
@@ -3,26 +3,64 @@
 
 #include <Arduino.h>
 #include <ESPAsyncWebServer.h>
+#include "command_batch.h"
+
+#define WEB_MOTOR_COUNT 4
+#define WEB_EVENT_MAX 96                // Ein Delta auf /events
+
+// Motorstand für den Event-Stream /events
+struct WebMotorState {
+    uint8_t position;               // %
+    const char* state;              // MotorController::getStateName()
+    bool calibrated;
+    bool calibrating;
+    bool moving;
+};
+
+// POST /api/batch: Body-Puffer in request->_tempObject, danach folgt der JSON-Text
+struct BatchBody {
+    const char* result;             // nullptr = noch unvollständig, sonst statischer Text
+    size_t received;
+};
 
 class WebServerHandler {
 private:
     AsyncWebServer server;
+    AsyncEventSource events;
+    
+    // Zuletzt an /events gesendeter Stand (nur Status-Task)
+    WebMotorState lastEvent[WEB_MOTOR_COUNT];
+    unsigned long lastEventAt[WEB_MOTOR_COUNT];
+    bool lastEventValid[WEB_MOTOR_COUNT];
+    bool eventResync;               // Neuer Client (AsyncTCP-Task): Vollstand senden
     
 public:
     WebServerHandler();
     void begin();
     
-    void (*onMotor1Command)(const char* cmd) = nullptr;
-    void (*onMotor2Command)(const char* cmd) = nullptr;
-    void (*onMotor3Command)(const char* cmd) = nullptr;
-    void (*onMotor4Command)(const char* cmd) = nullptr;
+    int8_t statusTask = -1;         // Scheduler-Task für den Status (wake bei neuem Client)
+    
+    // Sendet Deltas an alle /events-Clients: Zustandswechsel sofort, Position
+    // während der Fahrt höchstens alle WEB_EVENT_INTERVAL_MS.
+    // Rückgabe: Wartezeit bis zum nächsten Aufruf (UINT32_MAX = nur bei Wake)
+    uint32_t updateEvents(const WebMotorState* states, uint8_t count);
+    
+    // Alle Callbacks laufen im AsyncTCP-Task: nur in die CommandQueue posten,
+    // nie direkt auf Motoren zugreifen. false = nicht angenommen (HTTP 503)
+    bool (*onMotor1Command)(const char* cmd) = nullptr;
+    bool (*onMotor2Command)(const char* cmd) = nullptr;
+    bool (*onMotor3Command)(const char* cmd) = nullptr;
+    bool (*onMotor4Command)(const char* cmd) = nullptr;
+    bool (*onAllCommand)(const char* cmd) = nullptr;
     
-    void (*onMotor1Learn)(const char* type) = nullptr;
-    void (*onMotor2Learn)(const char* type) = nullptr;
-    void (*onMotor3Learn)(const char* type) = nullptr;
-    void (*onMotor4Learn)(const char* type) = nullptr;
+    bool (*onMotor1Learn)(const char* type) = nullptr;
+    bool (*onMotor2Learn)(const char* type) = nullptr;
+    bool (*onMotor3Learn)(const char* type) = nullptr;
+    bool (*onMotor4Learn)(const char* type) = nullptr;
+    bool (*onAllLearn)(const char* type) = nullptr;
     
-    String (*getStatusJson)() = nullptr;
+    // POST /api/batch
+    bool (*onBatch)(const CommandBatch& batch) = nullptr;
 };
 
 #endif
@@ -0,0 +1,130 @@
+// Automatisch erzeugt von tools/build_web.py aus web/index.html - nicht bearbeiten
+#ifndef WEB_UI_H
+#define WEB_UI_H
+
+#include <Arduino.h>
+
+#define WEB_UI_ETAG "\"57a0918798335f98\""
+#define WEB_UI_RAW_LEN 6926            // Unkomprimiert (nur Info)
+
+const size_t WEB_UI_GZ_LEN = 1852;
+const uint8_t WEB_UI_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xbd, 0x58, 0xeb, 0x6e, 0xdb, 0x36,
+    0x14, 0xfe, 0xef, 0xa7, 0x60, 0x35, 0x14, 0x93, 0x37, 0x4b, 0x96, 0x63, 0xb7, 0x6b, 0xe2, 0x38,
+    0x45, 0x96, 0xb9, 0x58, 0xd6, 0x2c, 0x29, 0x9a, 0x76, 0xc0, 0xd6, 0xf6, 0x07, 0x2d, 0x51, 0x16,
+    0x1b, 0xdd, 0x40, 0x51, 0xb9, 0xb4, 0xcd, 0x33, 0xec, 0xcf, 0xfe, 0x6f, 0x0f, 0xb2, 0xbd, 0xd3,
+    0x1e, 0x61, 0xe7, 0x90, 0x94, 0x44, 0x3b, 0x17, 0xef, 0x02, 0x0c, 0x01, 0x2c, 0x5e, 0xce, 0xf9,
+    0x78, 0x2e, 0x1f, 0x0f, 0xc9, 0xec, 0x3e, 0xf8, 0xe6, 0xe4, 0xe0, 0xd5, 0x8f, 0x2f, 0xe6, 0x24,
+    0x91, 0x59, 0xba, 0xd7, 0xdb, 0x6d, 0x3e, 0x8c, 0x46, 0xf0, 0xc9, 0x98, 0xa4, 0x24, 0x4c, 0xa8,
+    0xa8, 0x98, 0x9c, 0x39, 0xaf, 0x5f, 0x3d, 0xf3, 0x9e, 0x38, 0xcd, 0x70, 0x4e, 0x33, 0x36, 0x73,
+    0xce, 0x39, 0xbb, 0x28, 0x0b, 0x21, 0x1d, 0x12, 0x16, 0xb9, 0x64, 0x39, 0x88, 0x5d, 0xf0, 0x48,
+    0x26, 0xb3, 0x88, 0x9d, 0xf3, 0x90, 0x79, 0xaa, 0x33, 0x20, 0x3c, 0xe7, 0x92, 0xd3, 0xd4, 0xab,
+    0x42, 0x9a, 0xb2, 0xd9, 0xc8, 0x0f, 0x10, 0x46, 0x72, 0x99, 0xb2, 0xbd, 0x1f, 0x58, 0x5a, 0x5f,
+    0x92, 0x03, 0xd0, 0x16, 0x45, 0x9a, 0x32, 0xb1, 0x3b, 0xd4, 0xe3, 0xbd, 0xdd, 0x4a, 0x5e, 0xe1,
+    0xf7, 0x0b, 0xf2, 0x91, 0x64, 0x54, 0x2c, 0x79, 0xbe, 0x43, 0x82, 0x29, 0x29, 0x69, 0x14, 0xf1,
+    0x7c, 0xa9, 0xda, 0x8b, 0xe2, 0xd2, 0xab, 0xf8, 0x07, 0xd5, 0x5d, 0x14, 0x22, 0x62, 0xc2, 0x83,
+    0xa1, 0x29, 0xb9, 0xee, 0x2d, 0x8a, 0xe8, 0x0a, 0xf4, 0x62, 0x80, 0xf5, 0x62, 0x9a, 0xf1, 0xf4,
+    0x6a, 0x87, 0xec, 0x0b, 0x30, 0x61, 0x40, 0x2a, 0x9a, 0x57, 0x5e, 0xc5, 0x04, 0x8f, 0x01, 0x80,
+    0x86, 0x67, 0x4b, 0x51, 0xd4, 0x79, 0xb4, 0x43, 0x3e, 0x1b, 0x51, 0xfc, 0x9b, 0x82, 0x27, 0x69,
+    0x21, 0xa0, 0x1f, 0xc7, 0xb1, 0xb5, 0xdc, 0x56, 0x50, 0x2a, 0x64, 0x1f, 0x1d, 0xa5, 0x3c, 0x67,
+    0x42, 0xd9, 0x75, 0xa9, 0x5d, 0xdc, 0x21, 0xa3, 0xad, 0x40, 0x49, 0xb4, 0xa6, 0x12, 0x5a, 0xcb,
+    0x02, 0x35, 0x92, 0x11, 0x48, 0x4a, 0x76, 0x29, 0x3d, 0x9a, 0xf2, 0x25, 0x4c, 0x85, 0x10, 0x27,
+    0x26, 0x1a, 0x51, 0x30, 0x59, 0xca, 0x22, 0xdb, 0x21, 0x63, 0xa5, 0xdf, 0xac, 0x3e, 0x39, 0xd8,
+    0x7f, 0xf6, 0x28, 0x50, 0x2b, 0x66, 0x85, 0x2c, 0x44, 0x05, 0x20, 0x11, 0xaf, 0xca, 0x94, 0x82,
+    0x2b, 0x4b, 0xc1, 0xa3, 0xa9, 0xfa, 0xf5, 0x24, 0xcb, 0x60, 0x4c, 0x32, 0x0f, 0x14, 0xeb, 0x2c,
+    0xaf, 0x76, 0x88, 0x60, 0x25, 0xa3, 0xd2, 0xc5, 0xe5, 0xbd, 0x98, 0xcb, 0x01, 0xc9, 0x78, 0x0e,
+    0x86, 0xba, 0x63, 0x34, 0x70, 0x40, 0x46, 0xb1, 0xe8, 0xf7, 0x41, 0x99, 0x96, 0x96, 0x53, 0x6a,
+    0x09, 0x58, 0x61, 0x25, 0x20, 0x5b, 0x14, 0xff, 0xa6, 0x4d, 0x68, 0x05, 0x8d, 0x78, 0x0d, 0xf8,
+    0x23, 0xa5, 0xb4, 0x16, 0x18, 0x2d, 0x03, 0xbd, 0xf2, 0x92, 0x54, 0x45, 0xca, 0x23, 0xf2, 0xd9,
+    0x78, 0x3c, 0xb6, 0xb0, 0x93, 0x2d, 0x80, 0x5f, 0x77, 0x6e, 0x2d, 0x02, 0xa3, 0x47, 0x56, 0x8c,
+    0x81, 0x0e, 0x2b, 0x3e, 0xc7, 0x29, 0xbb, 0x34, 0x66, 0x8f, 0xac, 0x48, 0xdf, 0x50, 0x5e, 0xd4,
+    0xd0, 0xcf, 0x31, 0xf9, 0xa0, 0x00, 0xc3, 0x96, 0xa9, 0x5a, 0xa4, 0x31, 0x35, 0x2f, 0x72, 0x76,
+    0xc3, 0x39, 0x25, 0x11, 0xd6, 0xa2, 0x42, 0x3b, 0xcb, 0x82, 0xeb, 0x4c, 0x29, 0x1e, 0x01, 0xd3,
+    0x18, 0x60, 0x3c, 0x46, 0x09, 0x35, 0x70, 0xc1, 0xf8, 0x32, 0x91, 0x48, 0xbd, 0x14, 0xb2, 0x21,
+    0x05, 0x10, 0x0b, 0x68, 0x5e, 0x60, 0xf2, 0xfd, 0x71, 0xa5, 0x1c, 0x59, 0xc8, 0xdc, 0x2b, 0x4a,
+    0x96, 0xaf, 0x87, 0xb6, 0x09, 0x80, 0x09, 0xc8, 0x45, 0xc2, 0x25, 0x5b, 0x51, 0xd8, 0x49, 0x8a,
+    0x73, 0x76, 0x23, 0x23, 0x93, 0x47, 0x34, 0x98, 0x6c, 0xb7, 0x82, 0x61, 0x5a, 0x54, 0x6c, 0x5d,
+    0x26, 0x9e, 0x4c, 0xc6, 0xe3, 0xc7, 0x77, 0x40, 0x2b, 0x8d, 0xdb, 0xb1, 0x23, 0x3a, 0xda, 0x0e,
+    0x16, 0xad, 0x64, 0x25, 0x8b, 0xf2, 0x06, 0x74, 0xbc, 0xfd, 0x24, 0xb8, 0xcb, 0x6a, 0x54, 0xb8,
+    0x1d, 0x99, 0x3d, 0x7e, 0xb2, 0x1d, 0x68, 0x2a, 0x57, 0xc0, 0x0c, 0x25, 0xd0, 0xec, 0x9a, 0x20,
+    0x78, 0xd8, 0xed, 0x19, 0xcc, 0x0f, 0x31, 0x82, 0x92, 0xca, 0xba, 0x5a, 0x47, 0x52, 0x94, 0xea,
+    0xd2, 0x69, 0x31, 0x6f, 0x35, 0x81, 0x2d, 0x60, 0xa0, 0x01, 0xed, 0xfc, 0x4d, 0x0c, 0xc7, 0x52,
+    0x46, 0x45, 0xde, 0xd6, 0x16, 0x0f, 0xad, 0x37, 0x04, 0x31, 0x0b, 0xd8, 0x43, 0x66, 0x11, 0x3d,
+    0xd2, 0x51, 0x7c, 0x32, 0x99, 0x58, 0x58, 0x2d, 0xf3, 0x56, 0x77, 0xd1, 0x68, 0xfb, 0xf1, 0xb3,
+    0xf1, 0x0d, 0xb1, 0xdb, 0x43, 0x15, 0x2c, 0xbe, 0x8a, 0x22, 0xaa, 0x84, 0x69, 0x9a, 0x7a, 0x1b,
+    0xf6, 0x81, 0xde, 0x7a, 0xef, 0xeb, 0x4a, 0xf2, 0xf8, 0xca, 0x33, 0x15, 0x78, 0x43, 0x7d, 0x31,
+    0xd9, 0x02, 0x74, 0x00, 0x5d, 0xd9, 0xc4, 0x64, 0x12, 0xb4, 0xd4, 0x36, 0xb1, 0x7a, 0xa2, 0x82,
+    0x09, 0x18, 0x26, 0x5d, 0xa6, 0xc6, 0x35, 0xae, 0x18, 0x94, 0x5b, 0xdd, 0x5d, 0xe7, 0xc8, 0xee,
+    0xd0, 0xd4, 0xf3, 0xdd, 0xa1, 0x39, 0x5d, 0xb0, 0x46, 0xc3, 0x27, 0xe2, 0xe7, 0x24, 0x4c, 0x69,
+    0x55, 0xcd, 0x9c, 0xb6, 0xb4, 0xe2, 0xf1, 0x90, 0x8c, 0xf6, 0xfe, 0xfc, 0xf5, 0xe7, 0xdf, 0x88,
+    0x3e, 0x20, 0x5e, 0xc2, 0xe1, 0x40, 0x23, 0xd8, 0x48, 0xf6, 0x49, 0x01, 0x22, 0x2b, 0xfa, 0x76,
+    0xc8, 0x10, 0xc2, 0x24, 0xc4, 0xcc, 0x36, 0x6e, 0x37, 0x5b, 0xcc, 0x21, 0x45, 0x1e, 0xa6, 0x3c,
+    0x3c, 0xd3, 0x0b, 0x83, 0xd2, 0x7e, 0x9a, 0xba, 0x9f, 0x9f, 0xbc, 0x98, 0x1f, 0x7f, 0xde, 0x77,
+    0x60, 0xf1, 0x5f, 0x7e, 0x27, 0xfb, 0x47, 0x47, 0x73, 0xb2, 0xff, 0xfa, 0xd9, 0xee, 0x50, 0x63,
+    0xdd, 0x0b, 0xaa, 0x36, 0xd7, 0x1d, 0xa8, 0x07, 0x47, 0x27, 0xa7, 0x73, 0x03, 0xfb, 0x87, 0x86,
+    0xfd, 0xe9, 0xf5, 0x46, 0xd4, 0x36, 0xca, 0x16, 0xaa, 0x1a, 0x53, 0x98, 0x58, 0xe1, 0x11, 0x52,
+    0xa1, 0x3d, 0xdf, 0x3f, 0x3a, 0xfc, 0xfa, 0xe5, 0xe1, 0xfc, 0xe5, 0xfc, 0xd8, 0x82, 0x1d, 0x42,
+    0x74, 0x56, 0x63, 0xa4, 0x0f, 0x13, 0x87, 0xf0, 0xa8, 0x6d, 0xef, 0x35, 0x62, 0xe6, 0x53, 0x85,
+    0x82, 0x97, 0x72, 0xaf, 0x07, 0xf6, 0x57, 0x92, 0x98, 0xd3, 0x67, 0x46, 0xde, 0x8c, 0x06, 0x64,
+    0x6b, 0x40, 0xc6, 0x03, 0x32, 0x79, 0x37, 0xed, 0xc5, 0x75, 0x1e, 0x62, 0xb1, 0x23, 0xa1, 0x80,
+    0xd3, 0x86, 0x7d, 0x8f, 0x52, 0x07, 0x54, 0x44, 0x2e, 0x8f, 0xfa, 0xe4, 0x63, 0x4f, 0x30, 0x59,
+    0x03, 0xd7, 0x1d, 0x6b, 0xe9, 0xb7, 0x7a, 0xbd, 0xb7, 0xce, 0x9e, 0x43, 0xbe, 0xec, 0x39, 0xbb,
+    0xc9, 0xd6, 0x9e, 0xd2, 0x22, 0xd0, 0x05, 0x73, 0xe0, 0xc7, 0x81, 0x94, 0x6e, 0x99, 0x59, 0x5b,
+    0xaf, 0xc9, 0x69, 0xab, 0xba, 0x12, 0xad, 0xb7, 0x4e, 0x93, 0xd1, 0xb7, 0x5d, 0x98, 0x5a, 0x25,
+    0xb7, 0x43, 0x1f, 0x10, 0x93, 0x5c, 0xc0, 0xb1, 0x73, 0x7a, 0x27, 0x26, 0x96, 0xb4, 0xcd, 0x98,
+    0xa7, 0xaf, 0x4e, 0x5e, 0x28, 0x4c, 0x6c, 0x6c, 0x06, 0x55, 0x2c, 0xd9, 0x8c, 0x6a, 0x08, 0x03,
+    0xb0, 0x16, 0x4f, 0x34, 0xa8, 0x4a, 0x93, 0x6e, 0xf2, 0xbc, 0xac, 0x25, 0x91, 0x57, 0x25, 0x03,
+    0x1c, 0x38, 0x80, 0x96, 0x88, 0xdc, 0xac, 0xa6, 0x8b, 0x2d, 0x0c, 0xc0, 0x0e, 0x86, 0x6e, 0x80,
+    0x2d, 0x7a, 0x09, 0x2d, 0xa8, 0xba, 0xd0, 0x3e, 0xa7, 0x69, 0x8d, 0x6a, 0x8f, 0x02, 0x6d, 0x4d,
+    0x82, 0xea, 0x77, 0x98, 0x23, 0x13, 0x5e, 0xf9, 0x4a, 0x01, 0x2c, 0x42, 0xee, 0x34, 0xe8, 0x9d,
+    0x50, 0x9b, 0x1c, 0x3b, 0x73, 0xba, 0x8c, 0xb7, 0x2a, 0xaa, 0xb7, 0xa2, 0xf2, 0xa2, 0x68, 0xce,
+    0x4c, 0xcf, 0x7b, 0x68, 0x7b, 0x66, 0xa3, 0x28, 0xca, 0xaf, 0x27, 0xbf, 0x8b, 0x9f, 0x9a, 0x5e,
+    0x8d, 0x1e, 0xb2, 0x41, 0x05, 0xef, 0x84, 0xc5, 0x71, 0x5e, 0xe7, 0xcb, 0xea, 0x03, 0xe3, 0x12,
+    0xf6, 0x93, 0xc8, 0x59, 0x7e, 0x7b, 0x8e, 0xee, 0xc5, 0x53, 0x49, 0xd3, 0x49, 0x0e, 0x93, 0x94,
+    0xb3, 0xea, 0x1e, 0xbc, 0x3b, 0x9c, 0x68, 0x6b, 0xf9, 0x3f, 0xf7, 0x26, 0x86, 0xfb, 0x73, 0x95,
+    0xa8, 0xe5, 0x8f, 0xd4, 0x8a, 0x64, 0xc1, 0x58, 0x1e, 0xfd, 0x2b, 0x4f, 0x74, 0xd1, 0xc0, 0x1d,
+    0x00, 0x8d, 0x8c, 0x4a, 0x5e, 0x85, 0x09, 0x39, 0x83, 0x9b, 0xe9, 0x42, 0x70, 0x26, 0xee, 0x73,
+    0x46, 0x37, 0xa7, 0xbd, 0xeb, 0x9e, 0x2e, 0x09, 0x7e, 0x5c, 0x88, 0x39, 0x0d, 0x13, 0xb7, 0x29,
+    0x05, 0x66, 0xeb, 0x47, 0x45, 0x58, 0x67, 0x70, 0x04, 0xf9, 0x4b, 0x26, 0xe7, 0x29, 0xc3, 0xe6,
+    0xd7, 0x57, 0x87, 0x91, 0xdb, 0x94, 0x9b, 0xbe, 0xcf, 0x73, 0xa8, 0xf1, 0xdf, 0xbe, 0xfa, 0xfe,
+    0x88, 0x7c, 0x39, 0xbb, 0xad, 0x7e, 0xc0, 0x1a, 0x7d, 0xbb, 0xc2, 0x18, 0x42, 0x2a, 0xfd, 0x01,
+    0x09, 0x33, 0xb5, 0x4c, 0xcc, 0x24, 0xac, 0xed, 0x0c, 0xd5, 0x28, 0xba, 0xa8, 0xef, 0x99, 0xe0,
+    0xe5, 0xd0, 0x28, 0x3c, 0x05, 0xc9, 0x19, 0xce, 0xa0, 0x46, 0xcf, 0x97, 0x09, 0xcb, 0x3b, 0x5b,
+    0x05, 0x60, 0x10, 0x53, 0xa5, 0x84, 0x8f, 0xd7, 0x73, 0x17, 0x6e, 0xc5, 0xd7, 0x37, 0xe4, 0x22,
+    0x2a, 0x69, 0x5f, 0x5d, 0x5d, 0x73, 0x38, 0xf4, 0x99, 0x9f, 0x16, 0x4b, 0x3d, 0x86, 0xc2, 0x18,
+    0x8c, 0x75, 0x33, 0xb1, 0x34, 0xaf, 0x99, 0x08, 0x05, 0xfc, 0xff, 0xb5, 0x49, 0x57, 0x6e, 0x95,
+    0xfd, 0x63, 0x78, 0xa7, 0x61, 0xf5, 0xfe, 0x48, 0xd4, 0xb5, 0x92, 0x38, 0xb7, 0xed, 0x08, 0x20,
+    0x86, 0xbe, 0x19, 0x12, 0xe7, 0x16, 0x7e, 0x3b, 0x83, 0x9e, 0x66, 0x20, 0x4c, 0xaf, 0xf2, 0x0f,
+    0xf4, 0x90, 0x4f, 0x30, 0x7e, 0x07, 0x9b, 0x88, 0x1b, 0x53, 0x96, 0x08, 0x38, 0x45, 0xe0, 0x37,
+    0xa3, 0xc0, 0x7e, 0x5a, 0xc7, 0xc3, 0x0f, 0x75, 0xdf, 0x21, 0xd7, 0x56, 0x86, 0x35, 0x4f, 0x4d,
+    0x7e, 0xb1, 0x9a, 0x61, 0xf4, 0x78, 0x4c, 0x5c, 0x6c, 0x93, 0xd9, 0x6c, 0x46, 0x1c, 0x6d, 0x81,
+    0x43, 0x3e, 0x7d, 0x42, 0xb7, 0x63, 0x2e, 0x32, 0xd7, 0xe9, 0x8e, 0x8f, 0x36, 0xf7, 0x3b, 0xaa,
+    0xdb, 0x79, 0xfe, 0x06, 0x11, 0xde, 0xe1, 0xcc, 0x53, 0xa7, 0xbf, 0x81, 0x36, 0x4a, 0xeb, 0xa9,
+    0x2a, 0xa6, 0x38, 0xa1, 0xec, 0xf8, 0xaf, 0x29, 0x82, 0xf7, 0xae, 0x90, 0xab, 0xc9, 0xb9, 0x5e,
+    0xf3, 0x1b, 0x09, 0x63, 0xfb, 0xdc, 0xba, 0x07, 0x13, 0x8c, 0x28, 0x1f, 0x55, 0xe2, 0xfe, 0x9e,
+    0x5f, 0xc8, 0xb5, 0xff, 0xcd, 0x11, 0xcd, 0x33, 0x2c, 0xeb, 0x0c, 0x29, 0x66, 0xa7, 0x54, 0x20,
+    0x41, 0x84, 0x29, 0x09, 0xe6, 0x26, 0x01, 0x32, 0x4a, 0xf6, 0x0d, 0x8f, 0xe0, 0x06, 0x71, 0x67,
+    0x9d, 0xb0, 0x8f, 0x09, 0xbb, 0x58, 0xcc, 0x7a, 0x4e, 0x77, 0x5c, 0xa8, 0xd4, 0xf9, 0xa5, 0xe9,
+    0x63, 0x20, 0x1e, 0x0e, 0xc8, 0xf3, 0x86, 0x79, 0x52, 0x0b, 0xb8, 0x99, 0x1f, 0xaa, 0x21, 0x58,
+    0x34, 0x22, 0x4f, 0x89, 0xf3, 0xdd, 0xbe, 0x43, 0x60, 0xea, 0x78, 0x7e, 0x78, 0xec, 0xf4, 0xa1,
+    0xaa, 0x59, 0x02, 0x70, 0x0f, 0x46, 0x09, 0xe2, 0xb6, 0x20, 0xb0, 0x49, 0x48, 0x4a, 0x59, 0x1d,
+    0xcb, 0xbe, 0xd2, 0x72, 0xfa, 0xf7, 0x19, 0x6d, 0x1d, 0x87, 0x7d, 0x7d, 0x54, 0x82, 0xbb, 0x9d,
+    0x85, 0x2b, 0xa5, 0xa2, 0x2e, 0x21, 0x90, 0xec, 0x54, 0xf9, 0xe9, 0xda, 0xd9, 0x33, 0xae, 0x6f,
+    0xc8, 0xd6, 0xfb, 0x0a, 0x86, 0xee, 0xcb, 0xd6, 0x86, 0x0a, 0xdd, 0xa5, 0x03, 0xe5, 0xdf, 0x38,
+    0xed, 0x5e, 0x50, 0x79, 0x41, 0x0e, 0x66, 0x28, 0xd6, 0xe6, 0x0a, 0x1d, 0x99, 0xf6, 0xba, 0x8c,
+    0xaa, 0xe4, 0x9b, 0x2a, 0x7d, 0xad, 0xe4, 0x2f, 0x78, 0x1e, 0x15, 0x17, 0xfe, 0xfc, 0x1c, 0xe2,
+    0x71, 0x5a, 0xd4, 0x22, 0x64, 0xdd, 0x3a, 0x95, 0xea, 0x03, 0x46, 0xce, 0x2e, 0x88, 0x25, 0x01,
+    0xee, 0x32, 0xec, 0x55, 0x18, 0x57, 0x2d, 0xe4, 0xc3, 0x7b, 0x44, 0x49, 0x1c, 0xf1, 0x0a, 0xde,
+    0x32, 0xb0, 0x9a, 0xb1, 0x6d, 0x40, 0x5a, 0x17, 0x2c, 0xe4, 0x08, 0x40, 0xbf, 0x3b, 0x3d, 0x39,
+    0xf6, 0x4b, 0xfc, 0x17, 0x95, 0xcb, 0x7c, 0x4d, 0xcf, 0x1b, 0x74, 0x8b, 0xfc, 0xec, 0x1d, 0x16,
+    0x0e, 0xd7, 0xea, 0x62, 0x45, 0x2c, 0x5b, 0x36, 0x05, 0x50, 0x00, 0x5b, 0xa2, 0xc0, 0x1b, 0x0b,
+    0x2a, 0x15, 0xeb, 0x86, 0xd4, 0x13, 0x49, 0x8d, 0x29, 0xe6, 0xa3, 0xc3, 0x4e, 0x09, 0x77, 0x9a,
+    0x9c, 0x40, 0x38, 0x2d, 0x12, 0x42, 0x3c, 0xfd, 0xd2, 0xcc, 0x57, 0xdd, 0x7c, 0xb3, 0x3f, 0x22,
+    0xbf, 0x32, 0x93, 0x67, 0xdd, 0xa4, 0xc5, 0xcf, 0x19, 0x79, 0xf0, 0x20, 0xf2, 0xcf, 0x8c, 0x4c,
+    0x78, 0x53, 0x06, 0x29, 0xaa, 0x85, 0xc2, 0x36, 0x1d, 0xe0, 0x4c, 0x93, 0x09, 0xc2, 0xd0, 0x42,
+    0xc8, 0x1b, 0x93, 0x87, 0xf8, 0x02, 0x04, 0x12, 0xba, 0x36, 0xd3, 0x06, 0xf8, 0xdc, 0x0e, 0x54,
+    0xce, 0x56, 0x09, 0x38, 0xc5, 0xd7, 0x99, 0xb9, 0xf4, 0xc3, 0xf9, 0xaf, 0xdf, 0x65, 0x43, 0xf5,
+    0xbf, 0xc0, 0xbf, 0x00, 0x68, 0x5a, 0x68, 0x87, 0x22, 0x14, 0x00, 0x00,
+};
+
+#endif
@@ -0,0 +1,81 @@
+"""
+Webinterface für den Flash vorbereiten: web/index.html minimieren, gzippen und
+als PROGMEM-Array nach src/web_ui.h schreiben (inkl. ETag aus dem Inhalt).
+
+Läuft als PlatformIO-Pre-Script vor jedem Build (platformio.ini: extra_scripts)
+oder von Hand:  python tools/build_web.py
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+try:
+    Import("env")  # noqa: F821 - von PlatformIO/SCons bereitgestellt
+    PROJECT_DIR = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+SOURCE = os.path.join(PROJECT_DIR, "web", "index.html")
+TARGET = os.path.join(PROJECT_DIR, "src", "web_ui.h")
+
+
+def minify(html):
+    # Konservativ: Zeilen bleiben erhalten (JS ohne Semikolon-Analyse sicher)
+    html = re.sub(r"/\*.*?\*/", "", html, flags=re.S)        # CSS-Kommentare
+    html = re.sub(r"<!--.*?-->", "", html, flags=re.S)       # HTML-Kommentare
+    lines = []
+    for line in html.splitlines():
+        line = line.strip()
+        if not line or line.startswith("//"):
+            continue
+        lines.append(line)
+    return "\n".join(lines)
+
+
+def render(data, etag, raw_len):
+    rows = []
+    for i in range(0, len(data), 16):
+        rows.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return (
+        "// Automatisch erzeugt von tools/build_web.py aus web/index.html - nicht bearbeiten\n"
+        "#ifndef WEB_UI_H\n"
+        "#define WEB_UI_H\n"
+        "\n"
+        "#include <Arduino.h>\n"
+        "\n"
+        "#define WEB_UI_ETAG \"\\\"%s\\\"\"\n"
+        "#define WEB_UI_RAW_LEN %d            // Unkomprimiert (nur Info)\n"
+        "\n"
+        "const size_t WEB_UI_GZ_LEN = %d;\n"
+        "const uint8_t WEB_UI_GZ[] PROGMEM = {\n"
+        "%s\n"
+        "};\n"
+        "\n"
+        "#endif\n"
+    ) % (etag, raw_len, len(data), "\n".join(rows))
+
+
+def build():
+    with open(SOURCE, "r", encoding="utf-8") as f:
+        raw = f.read().encode("utf-8")
+    minified = minify(raw.decode("utf-8")).encode("utf-8")
+
+    # mtime=0: gleicher Inhalt -> gleiche Bytes -> gleicher ETag
+    data = gzip.compress(minified, compresslevel=9, mtime=0)
+    etag = hashlib.sha256(data).hexdigest()[:16]
+    header = render(data, etag, len(raw))
+
+    # Nur bei Änderung schreiben, sonst baut PlatformIO jedes Mal neu
+    if os.path.exists(TARGET):
+        with open(TARGET, "r", encoding="utf-8") as f:
+            if f.read() == header:
+                return
+    with open(TARGET, "w", encoding="utf-8", newline="\n") as f:
+        f.write(header)
+    print("Webinterface: %d -> %d Bytes (minimiert %d), ETag %s"
+          % (len(raw), len(data), len(minified), etag))
+
+
+build()